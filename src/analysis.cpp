@@ -0,0 +1,529 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "analysis.hpp"
+
+#include "parallel.hpp"
+
+#include <btu/common/string.hpp>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+namespace cao {
+template<typename T>
+[[nodiscard]] auto read_le(std::span<const std::byte> data, size_t offset) noexcept -> std::optional<T>
+{
+    if (offset + sizeof(T) > data.size())
+        return std::nullopt;
+
+    T value{};
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+[[nodiscard]] constexpr auto make_four_cc(const char (&str)[5]) noexcept -> uint32_t
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(str[0]))
+           | static_cast<uint32_t>(static_cast<uint8_t>(str[1])) << 8U
+           | static_cast<uint32_t>(static_cast<uint8_t>(str[2])) << 16U
+           | static_cast<uint32_t>(static_cast<uint8_t>(str[3])) << 24U;
+}
+
+struct ImageInfo
+{
+    btu::tex::Dimension dimension;
+    uint32_t mip_count = 1;
+    /// Nothing if the format is not known
+    std::optional<uint32_t> bits_per_pixel;
+    bool compressed = false;
+    bool alpha      = false;
+    uint64_t header_size{};
+};
+
+[[nodiscard]] auto bits_per_pixel(uint32_t dxgi_format) noexcept -> std::optional<uint32_t>
+{
+    constexpr uint32_t k_bc1_first = 70; // DXGI_FORMAT_BC1_TYPELESS
+    constexpr uint32_t k_bc5_last  = 84; // DXGI_FORMAT_BC5_SNORM
+    constexpr uint32_t k_bc6_first = 94; // DXGI_FORMAT_BC6H_TYPELESS
+    constexpr uint32_t k_bc7_last  = 99; // DXGI_FORMAT_BC7_UNORM_SRGB
+
+    if (dxgi_format >= k_bc1_first && dxgi_format <= k_bc5_last)
+    {
+        const bool half_byte = dxgi_format <= 72 || (dxgi_format >= 79 && dxgi_format <= 81); // BC1 and BC4
+        return half_byte ? 4 : 8;
+    }
+    if (dxgi_format >= k_bc6_first && dxgi_format <= k_bc7_last)
+        return 8;
+    if ((dxgi_format >= 27 && dxgi_format <= 32) || (dxgi_format >= 87 && dxgi_format <= 93)) // RGBA8, BGRA8
+        return 32;
+    return std::nullopt;
+}
+
+[[nodiscard]] auto parse_dds_header(std::span<const std::byte> header) noexcept -> std::optional<ImageInfo>
+{
+    constexpr uint32_t k_fourcc_flag       = 0x4;
+    constexpr uint32_t k_alpha_pixels_flag = 0x1;
+    constexpr uint64_t k_header_size       = 128;
+    constexpr uint64_t k_dx10_header_size  = 20;
+
+    if (read_le<uint32_t>(header, 0) != make_four_cc("DDS "))
+        return std::nullopt;
+
+    const auto height   = read_le<uint32_t>(header, 12);
+    const auto width    = read_le<uint32_t>(header, 16);
+    const auto mips     = read_le<uint32_t>(header, 28);
+    const auto pf_flags = read_le<uint32_t>(header, 80);
+    const auto four_cc  = read_le<uint32_t>(header, 84);
+    const auto rgb_bits = read_le<uint32_t>(header, 88);
+    if (!height || !width || !mips || !pf_flags || !four_cc || !rgb_bits)
+        return std::nullopt;
+
+    auto info = ImageInfo{
+        .dimension   = {.w = *width, .h = *height},
+        .mip_count   = std::max(*mips, 1U),
+        .alpha       = (*pf_flags & k_alpha_pixels_flag) != 0,
+        .header_size = k_header_size,
+    };
+
+    if ((*pf_flags & k_fourcc_flag) == 0)
+    {
+        info.bits_per_pixel = *rgb_bits;
+        return info;
+    }
+
+    info.compressed = true;
+    switch (*four_cc)
+    {
+        case make_four_cc("DXT1"):
+        case make_four_cc("ATI1"):
+        case make_four_cc("BC4U"):
+        case make_four_cc("BC4S"): info.bits_per_pixel = 4; break;
+        case make_four_cc("DXT2"):
+        case make_four_cc("DXT3"):
+        case make_four_cc("DXT4"):
+        case make_four_cc("DXT5"):
+        case make_four_cc("ATI2"):
+        case make_four_cc("BC5U"):
+        case make_four_cc("BC5S"):
+            info.bits_per_pixel = 8;
+            info.alpha          = true;
+            break;
+        case make_four_cc("DX10"):
+        {
+            const auto dxgi_format = read_le<uint32_t>(header, k_header_size);
+            if (!dxgi_format)
+                return std::nullopt;
+
+            info.header_size += k_dx10_header_size;
+            info.bits_per_pixel = bits_per_pixel(*dxgi_format);
+            info.compressed     = info.bits_per_pixel != 32U;
+            info.alpha          = info.bits_per_pixel != 4U;
+            break;
+        }
+        default: break; // unknown format, the size cannot be estimated
+    }
+    return info;
+}
+
+[[nodiscard]] auto parse_tga_header(std::span<const std::byte> header) noexcept -> std::optional<ImageInfo>
+{
+    constexpr uint64_t k_header_size = 18;
+
+    const auto width  = read_le<uint16_t>(header, 12);
+    const auto height = read_le<uint16_t>(header, 14);
+    const auto depth  = read_le<uint8_t>(header, 16);
+    if (!width || !height || !depth)
+        return std::nullopt;
+
+    return ImageInfo{
+        .dimension      = {.w = *width, .h = *height},
+        .bits_per_pixel = *depth,
+        .alpha          = *depth == 32,
+        .header_size    = k_header_size,
+    };
+}
+
+[[nodiscard]] auto target_dimension(const btu::tex::Dimension &dim, const btu::tex::Settings &sets) noexcept
+    -> btu::tex::Dimension
+{
+    return std::visit(btu::common::Overload{
+                          [&](std::monostate) { return dim; },
+                          [&](const btu::tex::Dimension &max) {
+                              return btu::tex::Dimension{
+                                  .w = std::min(dim.w, max.w),
+                                  .h = std::min(dim.h, max.h),
+                              };
+                          },
+                          [&](const btu::tex::util::ResizeRatio &ratio) {
+                              if (ratio.ratio <= 1)
+                                  return dim;
+                              return btu::tex::Dimension{
+                                  .w = std::min(dim.w, std::max(dim.w / ratio.ratio, ratio.min.w)),
+                                  .h = std::min(dim.h, std::max(dim.h / ratio.ratio, ratio.min.h)),
+                              };
+                          },
+                      },
+                      sets.resize);
+}
+
+[[nodiscard]] auto analyze_texture(FileAnalysis analysis,
+                                   const ImageInfo &image,
+                                   bool is_tga,
+                                   const btu::tex::Settings &sets,
+                                   OptimizeType type) -> FileAnalysis
+{
+    const auto full_mip_count = static_cast<uint32_t>(
+        std::bit_width(std::max(image.dimension.w, image.dimension.h)));
+
+    auto bits   = image.bits_per_pixel;
+    bool mipped = image.mip_count > 1;
+
+    if (is_tga)
+        analysis.steps.emplace_back("convert to dds");
+
+    if (sets.compress && !image.compressed)
+    {
+        analysis.steps.emplace_back("compress");
+        bits = image.alpha ? 8 : 4;
+    }
+
+    if (sets.mipmaps && image.mip_count < full_mip_count)
+    {
+        analysis.steps.emplace_back("generate mipmaps");
+        mipped = true;
+    }
+
+    const auto dim = target_dimension(image.dimension, sets);
+    if (dim.w != image.dimension.w || dim.h != image.dimension.h)
+        analysis.steps.emplace_back(fmt::format("resize to {}x{}", dim.w, dim.h));
+
+    if (type == OptimizeType::Forced && analysis.steps.empty())
+        analysis.steps.emplace_back("convert (forced)");
+
+    if (analysis.steps.empty() || !bits)
+        return analysis;
+
+    // A full mip chain adds a third to the size of the top level
+    const auto top_level     = uint64_t{dim.w} * dim.h * *bits / 8;
+    analysis.estimated_size = image.header_size + (mipped ? top_level * 4 / 3 : top_level);
+    return analysis;
+}
+
+/// @brief Value of the Bethesda stream version field of meshes made for a game
+[[nodiscard]] auto nif_stream_version(btu::Game game) noexcept -> std::optional<uint32_t>
+{
+    switch (game)
+    {
+        case btu::Game::TES4: return 11;
+        case btu::Game::FNV: return 34;
+        case btu::Game::SLE: return 83;
+        case btu::Game::SSE: return 100;
+        case btu::Game::FO4: return 130;
+        case btu::Game::Starfield: return 172;
+        default: return std::nullopt;
+    }
+}
+
+[[nodiscard]] auto analyze_mesh(FileAnalysis analysis,
+                                std::span<const std::byte> header,
+                                const btu::nif::Settings &sets,
+                                OptimizeType type) -> std::optional<FileAnalysis>
+{
+    constexpr auto k_nif_magic = std::string_view("Gamebryo File Format");
+
+    const auto text = std::string_view(reinterpret_cast<const char *>(header.data()), header.size());
+    if (!text.starts_with(k_nif_magic))
+        return std::nullopt;
+
+    const auto line_end = text.find('\n');
+    if (line_end == std::string_view::npos)
+        return std::nullopt;
+
+    // version, endianness, user version, block count, then the Bethesda stream version
+    const auto stream_version = read_le<uint32_t>(header, line_end + 1 + 4 + 1 + 4 + 4);
+    const auto target_version = nif_stream_version(sets.target_game);
+
+    // Other steps depend on the content of the blocks, which is not in the header
+    const bool wrong_version = stream_version && target_version && stream_version != target_version;
+    if (type == OptimizeType::Forced || wrong_version)
+        analysis.steps.emplace_back("convert to target game format");
+
+    return analysis;
+}
+
+[[nodiscard]] auto analyze_animation(FileAnalysis analysis,
+                                     std::span<const std::byte> header,
+                                     btu::Game target,
+                                     OptimizeType type) -> std::optional<FileAnalysis>
+{
+    constexpr uint32_t k_hkx_magic_1 = 0x57E0E057;
+    constexpr uint32_t k_hkx_magic_2 = 0x10C0C010;
+
+    if (read_le<uint32_t>(header, 0) != k_hkx_magic_1 || read_le<uint32_t>(header, 4) != k_hkx_magic_2)
+        return std::nullopt;
+
+    // Skyrim SE uses 64 bits animations, the other games 32 bits ones
+    const auto pointer_size = read_le<uint8_t>(header, 16);
+    if (!pointer_size)
+        return std::nullopt;
+
+    const uint8_t target_pointer_size = target == btu::Game::SSE ? 8 : 4;
+    if (type == OptimizeType::Forced || *pointer_size != target_pointer_size)
+        analysis.steps.emplace_back(fmt::format("convert to {} bits", target_pointer_size * 8));
+
+    return analysis;
+}
+
+[[nodiscard]] auto read_header(const std::filesystem::path &path) -> std::vector<std::byte>
+{
+    auto header = std::vector<std::byte>(k_analysis_header_size);
+
+    std::ifstream stream(path, std::ios::binary);
+    stream.read(reinterpret_cast<char *>(header.data()), static_cast<std::streamsize>(header.size()));
+    header.resize(static_cast<size_t>(std::max(stream.gcount(), std::streamsize{0})));
+    return header;
+}
+
+[[nodiscard]] auto is_archive(const std::filesystem::path &path) -> bool
+{
+    const auto extension = btu::common::to_lower(path.extension().u8string());
+    return extension == u8".bsa" || extension == u8".ba2";
+}
+
+[[nodiscard]] auto to_string(FileType type) noexcept -> std::string_view
+{
+    switch (type)
+    {
+        case FileType::Mesh: return "mesh";
+        case FileType::Texture: return "texture";
+        case FileType::Animation: return "animation";
+    }
+    return "unknown";
+}
+
+auto analyze_header(const btu::Path &relative_path,
+                    std::span<const std::byte> header,
+                    uint64_t file_size,
+                    const PerFileSettings &file_sets) -> std::optional<FileAnalysis>
+{
+    const auto type = guess_file_type(relative_path);
+    if (!type)
+        return std::nullopt;
+
+    auto analysis = FileAnalysis{
+        .relative_path  = relative_path,
+        .type           = *type,
+        .size           = file_size,
+        .estimated_size = file_size,
+    };
+
+    switch (*type)
+    {
+        case FileType::Mesh:
+        {
+            if (file_sets.nif_optimize == OptimizeType::None)
+                return analysis;
+            return analyze_mesh(std::move(analysis), header, file_sets.nif, file_sets.nif_optimize);
+        }
+        case FileType::Texture:
+        {
+            if (file_sets.tex_optimize == OptimizeType::None)
+                return analysis;
+
+            const bool is_tga = btu::common::to_lower(relative_path.extension().u8string()) == u8".tga";
+            const auto image  = is_tga ? parse_tga_header(header) : parse_dds_header(header);
+            if (!image)
+                return std::nullopt;
+            return analyze_texture(std::move(analysis),
+                                   *image,
+                                   is_tga,
+                                   file_sets.tex,
+                                   file_sets.tex_optimize);
+        }
+        case FileType::Animation:
+        {
+            if (file_sets.hkx_optimize == OptimizeType::None)
+                return analysis;
+            return analyze_animation(std::move(analysis),
+                                     header,
+                                     file_sets.hkx_target,
+                                     file_sets.hkx_optimize);
+        }
+    }
+    return std::nullopt;
+}
+
+auto analyze_mod(const btu::Path &mod_path,
+                 const PerFileSettingsMatcher &matcher,
+                 Executor &executor,
+                 size_t max_concurrency,
+                 std::stop_token stop_token,
+                 const std::function<void(size_t)> &count_callback,
+                 const std::function<void(const btu::Path &)> &progress_callback) -> ModAnalysis
+{
+    struct Task
+    {
+        btu::Path relative_path;
+        std::optional<FileAnalysis> analysis;
+    };
+
+    auto result = ModAnalysis{.path = mod_path};
+    auto tasks  = std::vector<Task>{};
+
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(mod_path, ec))
+    {
+        if (!entry.is_regular_file(ec))
+            continue;
+
+        if (is_archive(entry.path()))
+            result.archives.emplace_back(entry.path().lexically_relative(mod_path), entry.file_size(ec));
+        else if (guess_file_type(entry.path()))
+            tasks.emplace_back(Task{.relative_path = entry.path().lexically_relative(mod_path)});
+    }
+
+    count_callback(tasks.size());
+
+    // Each task owns its result, so no lock is needed
+    parallel_for_each(executor, Lane::Io, std::span(tasks), max_concurrency, stop_token, [&](Task &task) {
+        const auto path = mod_path / task.relative_path;
+
+        std::error_code size_ec;
+        const auto size = std::filesystem::file_size(path, size_ec);
+        if (!size_ec)
+        {
+            const auto &file_sets = matcher.find(task.relative_path);
+            task.analysis         = analyze_header(task.relative_path, read_header(path), size, file_sets);
+        }
+
+        progress_callback(task.relative_path);
+    });
+
+    for (auto &task : tasks)
+    {
+        if (!task.analysis)
+        {
+            result.unreadable_files.emplace_back(std::move(task.relative_path));
+            continue;
+        }
+
+        if (!task.analysis->steps.empty())
+            PLOGI << fmt::format("{} might be optimized. Steps: {}",
+                                 task.relative_path.string(),
+                                 fmt::join(task.analysis->steps, ", "));
+
+        result.files.emplace_back(std::move(*task.analysis));
+    }
+    return result;
+}
+
+void AnalysisReport::add(ModAnalysis analysis)
+{
+    const auto lock = std::scoped_lock(mutex_);
+    mods_.emplace_back(std::move(analysis));
+}
+
+auto AnalysisReport::to_json() const -> nlohmann::json
+{
+    const auto lock = std::scoped_lock(mutex_);
+
+    uint64_t total_size      = 0;
+    uint64_t total_estimated = 0;
+    size_t total_with_work   = 0;
+
+    auto mods = nlohmann::json::array();
+    for (const auto &mod : mods_)
+    {
+        uint64_t size      = 0;
+        uint64_t estimated = 0;
+        size_t with_work   = 0;
+
+        auto files = nlohmann::json::array();
+        for (const auto &file : mod.files)
+        {
+            size += file.size;
+            estimated += file.estimated_size;
+            if (file.steps.empty())
+                continue;
+
+            ++with_work;
+            files.push_back({
+                {"path", btu::common::as_ascii_string(file.relative_path.u8string())},
+                {"type", to_string(file.type)},
+                {"size", file.size},
+                {"estimated_size", file.estimated_size},
+                {"steps", file.steps},
+            });
+        }
+
+        auto archives = nlohmann::json::array();
+        for (const auto &[path, archive_size] : mod.archives)
+            archives.push_back({
+                {"path", btu::common::as_ascii_string(path.u8string())},
+                {"size", archive_size},
+            });
+
+        auto unreadable = nlohmann::json::array();
+        for (const auto &path : mod.unreadable_files)
+            unreadable.push_back(btu::common::as_ascii_string(path.u8string()));
+
+        mods.push_back({
+            {"path", btu::common::as_ascii_string(mod.path.u8string())},
+            {"files", std::move(files)},
+            {"archives_not_analyzed", std::move(archives)},
+            {"unreadable_files", std::move(unreadable)},
+            {"totals",
+             {
+                 {"files", mod.files.size()},
+                 {"files_with_work", with_work},
+                 {"size", size},
+                 {"estimated_size", estimated},
+             }},
+        });
+
+        total_size += size;
+        total_estimated += estimated;
+        total_with_work += with_work;
+    }
+
+    return {
+        {"mods", std::move(mods)},
+        {"totals",
+         {
+             {"mods", mods_.size()},
+             {"files_with_work", total_with_work},
+             {"size", total_size},
+             {"estimated_size", total_estimated},
+         }},
+    };
+}
+
+auto AnalysisReport::write(const std::filesystem::path &report_path) const -> bool
+{
+    const auto json = to_json();
+
+    std::error_code ec;
+    std::filesystem::create_directories(report_path.parent_path(), ec);
+
+    std::ofstream stream(report_path);
+    stream << json.dump(4);
+    if (!stream)
+        return false;
+
+    const auto &totals = json["totals"];
+    PLOGI << fmt::format("Dry run: {} files could be optimized. Estimated size: {} MB -> {} MB",
+                         totals["files_with_work"].get<size_t>(),
+                         totals["size"].get<uint64_t>() / (1024 * 1024),
+                         totals["estimated_size"].get<uint64_t>() / (1024 * 1024));
+    PLOGI << "Dry run report written to " << report_path.string();
+    return true;
+}
+} // namespace cao
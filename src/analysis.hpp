@@ -0,0 +1,78 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "executor.hpp"
+#include "main_process.hpp"
+#include "settings/per_file_settings_matcher.hpp"
+
+#include <btu/common/path.hpp>
+
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+namespace cao {
+/// @brief What would be done to a file, guessed from its header only
+struct FileAnalysis
+{
+    btu::Path relative_path;
+    FileType type{};
+    uint64_t size           = 0;
+    uint64_t estimated_size = 0;
+    std::vector<std::string> steps;
+};
+
+struct ModAnalysis
+{
+    btu::Path path;
+    std::vector<FileAnalysis> files;
+    /// Files whose header could not be understood
+    std::vector<btu::Path> unreadable_files;
+    /// Archives are not opened, their content would have to be decompressed
+    std::vector<std::pair<btu::Path, uint64_t>> archives;
+};
+
+/// Enough to hold the DDS, TGA, NIF and HKX headers
+constexpr size_t k_analysis_header_size = 256;
+
+/// @brief Guesses the steps needed by a file and its size after processing.
+/// Only steps that can be seen in the header are found: for example, headparts are not detected.
+/// @param header The first bytes of the file, up to `k_analysis_header_size`
+/// @return Nothing if the header cannot be understood
+[[nodiscard]] auto analyze_header(const btu::Path &relative_path,
+                                  std::span<const std::byte> header,
+                                  uint64_t file_size,
+                                  const PerFileSettings &file_sets) -> std::optional<FileAnalysis>;
+
+/// @brief Analyzes the loose files of a mod, only reading their headers
+/// @param count_callback Called once with the number of files to analyze
+/// @param progress_callback Called from several threads, once per analyzed file
+[[nodiscard]] auto analyze_mod(const btu::Path &mod_path,
+                               const PerFileSettingsMatcher &matcher,
+                               Executor &executor,
+                               size_t max_concurrency,
+                               std::stop_token stop_token,
+                               const std::function<void(size_t)> &count_callback,
+                               const std::function<void(const btu::Path &)> &progress_callback)
+    -> ModAnalysis;
+
+/// @brief Analyses of all the mods of a run. Mods can be added from any thread
+class AnalysisReport
+{
+public:
+    void add(ModAnalysis analysis);
+
+    [[nodiscard]] auto to_json() const -> nlohmann::json;
+    [[nodiscard]] auto write(const std::filesystem::path &report_path) const -> bool;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<ModAnalysis> mods_;
+};
+} // namespace cao
@@ -1,89 +1,285 @@
-#include "bsa_process.hpp"
-
-#include <format>
-
-#include <btu/bsa/pack.hpp>
-#include <btu/bsa/plugin.hpp>
-#include <btu/common/filesystem.hpp>
-#include <plog/Log.h>
-
-#include <fstream>
-
-/**
- * @brief Remove relative paths from a directory
- * Also removes directories made empty by the removal of the files
- * Remove the files case-insensitively (this is useful because the paths are lowercase)
- */
-auto remove_files_from_directory(const btu::Path &directory, std::span<const btu::Path> paths) noexcept
-    -> size_t
-{
-    const auto files_to_remove = btu::common::find_matching_paths_icase(directory, paths);
-
-    size_t count{};
-    std::error_code ec; // just ignore errors
-
-    for (const auto &real_path : files_to_remove)
-    {
-        count += btu::fs::remove(real_path, ec) ? 1 : 0;
-
-        // Remove the parent directory if it is empty
-        // TODO: improve this: sometimes empty dirs are left
-        if (auto parent_dir = real_path.parent_path(); btu::fs::is_empty(parent_dir))
-            btu::fs::remove(parent_dir, ec);
-    }
-
-    return count;
-}
-
-void write_single_archive(const btu::Path &directory_path,
-                          btu::bsa::Archive &&archive,
-                          const btu::bsa::Settings &bsa_sets,
-                          const bool remove_files,
-                          const bool make_override)
-{
-    const auto archive_path_opt = find_archive_name(directory_path, bsa_sets, archive.type());
-    if (!archive_path_opt)
-    {
-        PLOGE << "Failed to find a name for the archive, skipping";
-        return;
-    }
-    auto archive_path = std::move(archive_path_opt).value();
-
-    if (const bool success = std::move(archive).write(archive_path); !success)
-    {
-        PLOGE << "Failed to write archive " << archive_path.string();
-        return;
-    }
-
-    // we open the archive again to make sure the files are written
-    auto written_archive = btu::bsa::Archive::read(archive_path);
-    if (!written_archive)
-    {
-        PLOGE << "Archive was written but cannot be opened, it is likely corrupted. Removing it.";
-        btu::fs::remove(archive_path);
-    }
-
-    if (remove_files)
-    {
-        PLOGI << "Removing files that were packed into the archive";
-        auto relative_paths = flux::from_range(written_archive.value())
-                                  .map([](const auto &file) { return file.first; })
-                                  .to<std::vector<btu::Path>>();
-
-        written_archive.reset(); // close the archive before removing the files
-        const auto count = remove_files_from_directory(directory_path, relative_paths);
-        PLOGI << std::format("Attempted to remove {} files, {} were removed", relative_paths.size(), count);
-    }
-
-    if (make_override)
-    {
-        const auto override_path = std::move(archive_path).replace_extension(".override");
-
-        btu::common::write_file_new(override_path, {}).map_error([](const btu::common::Error &e) {
-            if (e == std::errc::file_exists)
-                return; // this is fine
-
-            PLOGE << "Failed to create override file: " << e;
-        });
-    }
-}
+#include "bsa_process.hpp"
+
+#include <format>
+
+#include <btu/bsa/pack.hpp>
+#include <btu/bsa/plugin.hpp>
+#include <btu/common/filesystem.hpp>
+#include <btu/common/string.hpp>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <numeric>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief Remove relative paths from a directory
+ * Also removes directories made empty by the removal of the files
+ * Remove the files case-insensitively (this is useful because the paths are lowercase)
+ */
+auto remove_files_from_directory(const btu::Path &directory, std::span<const btu::Path> paths) noexcept
+    -> size_t
+{
+    const auto files_to_remove = btu::common::find_matching_paths_icase(directory, paths);
+
+    size_t count{};
+    std::error_code ec; // just ignore errors
+
+    for (const auto &real_path : files_to_remove)
+    {
+        count += btu::fs::remove(real_path, ec) ? 1 : 0;
+
+        // Remove the parent directory if it is empty
+        // TODO: improve this: sometimes empty dirs are left
+        if (auto parent_dir = real_path.parent_path(); btu::fs::is_empty(parent_dir))
+            btu::fs::remove(parent_dir, ec);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Groups the archives that have at least one file in common
+ * Archives that cannot be read are left alone in their group. The order of `archives` is kept in each group,
+ * and groups are ordered by their first archive
+ */
+auto group_overlapping_archives(std::span<const btu::Path> archives) -> std::vector<std::vector<btu::Path>>
+{
+    // Union-find over the archive indices
+    auto parents = std::vector<size_t>(archives.size());
+    std::iota(parents.begin(), parents.end(), size_t{0});
+
+    const auto find_root = [&parents](size_t index) {
+        while (parents[index] != index)
+            index = parents[index] = parents[parents[index]];
+        return index;
+    };
+
+    auto first_archive = std::unordered_map<std::u8string, size_t>{};
+    for (size_t i = 0; i < archives.size(); ++i)
+    {
+        const auto archive = btu::bsa::Archive::read(archives[i]);
+        if (!archive)
+            continue;
+
+        for (const auto &[relative_path, file] : *archive)
+        {
+            auto key = btu::common::to_lower(btu::Path(relative_path).lexically_normal().generic_u8string());
+            std::ranges::replace(key, u8'\\', u8'/');
+
+            const auto [it, inserted] = first_archive.try_emplace(std::move(key), i);
+            if (!inserted)
+                parents[find_root(i)] = find_root(it->second);
+        }
+    }
+
+    auto groups        = std::vector<std::vector<btu::Path>>{};
+    auto group_of_root = std::unordered_map<size_t, size_t>{};
+    for (size_t i = 0; i < archives.size(); ++i)
+    {
+        const auto [it, inserted] = group_of_root.try_emplace(find_root(i), groups.size());
+        if (inserted)
+            groups.emplace_back();
+        groups[it->second].push_back(archives[i]);
+    }
+    return groups;
+}
+
+/// @brief Little endian integer of `size` bytes at `offset`
+[[nodiscard]] auto read_le(std::span<const char> bytes, size_t offset, size_t size) noexcept -> uint64_t
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i)
+        value |= uint64_t{static_cast<unsigned char>(bytes[offset + i])} << (8 * i);
+    return value;
+}
+
+/**
+ * @brief Checks the header of an archive, without reading the rest of it
+ * The file count must match the packed files, and the index described by the header must fit in the file
+ */
+auto has_valid_archive_header(const btu::Path &archive_path, size_t expected_files) noexcept -> bool
+{
+    constexpr auto k_tes3_magic = std::array<char, 4>{0x00, 0x01, 0x00, 0x00};
+    constexpr auto k_tes4_magic = std::array<char, 4>{'B', 'S', 'A', '\0'};
+    constexpr auto k_fo4_magic  = std::array<char, 4>{'B', 'T', 'D', 'X'};
+
+    std::error_code ec;
+    const auto file_size = btu::fs::file_size(archive_path, ec);
+    if (ec)
+        return false;
+
+    auto header = std::array<char, 36>{};
+
+    std::ifstream stream(archive_path, std::ios::binary);
+    stream.read(header.data(), header.size());
+    const auto header_size = static_cast<size_t>(stream.gcount());
+    if (header_size < 4)
+        return false;
+
+    auto magic = std::array<char, 4>{};
+    std::copy_n(header.begin(), magic.size(), magic.begin());
+
+    const auto field = [&header](size_t offset, size_t size = 4) { return read_le(header, offset, size); };
+
+    if (magic == k_tes3_magic)
+    {
+        if (header_size < 12)
+            return false;
+
+        // Size and offset records and name offsets come before the names, the hash table follows them
+        const auto hash_offset = field(4);
+        const auto file_count  = field(8);
+        return file_count == expected_files && hash_offset >= file_count * 12
+               && 12 + hash_offset + file_count * 8 <= file_size;
+    }
+
+    if (magic == k_tes4_magic)
+    {
+        if (header_size < 36)
+            return false;
+
+        const auto version           = field(4);
+        const auto folder_offset     = field(8);
+        const auto flags             = field(12);
+        const auto folder_count      = field(16);
+        const auto file_count        = field(20);
+        const auto folder_names_size = field(24);
+        const auto file_names_size   = field(28);
+
+        if (version != 103 && version != 104 && version != 105)
+            return false;
+        if (folder_offset != 36 || file_count != expected_files || folder_count > file_count)
+            return false;
+        if (file_count != 0 && folder_count == 0)
+            return false;
+
+        // Folder names are prefixed by their length, file names follow the file records
+        const uint64_t folder_record_size = version == 105 ? 24 : 16;
+        const bool has_folder_names       = (flags & 0x1U) != 0;
+        const bool has_file_names         = (flags & 0x2U) != 0;
+
+        const auto index_size = folder_offset + folder_count * folder_record_size + file_count * 16
+                                + (has_folder_names ? folder_names_size + folder_count : 0)
+                                + (has_file_names ? file_names_size : 0);
+        return index_size <= file_size;
+    }
+
+    if (magic == k_fo4_magic)
+    {
+        if (header_size < 24)
+            return false;
+
+        const auto version           = field(4);
+        const auto type              = std::string_view(header.data() + 8, 4);
+        const auto file_count        = field(12);
+        const auto name_table_offset = field(16, 8);
+
+        if (version != 1 && version != 2 && version != 3 && version != 7 && version != 8)
+            return false;
+
+        // Later versions add fields after the name table offset
+        const uint64_t fixed_size = [&] {
+            switch (version)
+            {
+                case 2: return 32;
+                case 3: return 36;
+                default: return 24;
+            }
+        }();
+
+        // Texture records have a variable number of chunks, only their fixed part is counted
+        const uint64_t record_size = [&]() -> uint64_t {
+            if (type == "GNRL")
+                return 36;
+            if (type == "DX10" || type == "GNMF")
+                return 24;
+            return 0;
+        }();
+        if (record_size == 0 || file_count != expected_files)
+            return false;
+
+        // Each name is prefixed by its 16 bits length
+        return name_table_offset >= fixed_size + file_count * record_size
+               && name_table_offset + file_count * 2 <= file_size;
+    }
+
+    return false;
+}
+
+auto write_single_archive(const btu::Path &directory_path,
+                          btu::bsa::Archive &&archive,
+                          const btu::bsa::Settings &bsa_sets,
+                          const ArchiveVerification verification,
+                          const bool make_override,
+                          cao::RunStatistics &stats) -> std::vector<btu::Path>
+{
+    const auto archive_path_opt = find_archive_name(directory_path, bsa_sets, archive.type());
+    if (!archive_path_opt)
+    {
+        PLOGE << "Failed to find a name for the archive, skipping";
+        return {};
+    }
+    auto archive_path = std::move(archive_path_opt).value();
+
+    auto relative_paths = flux::from_range(archive)
+                              .map([](const auto &file) { return file.first; })
+                              .to<std::vector<btu::Path>>();
+
+    {
+        auto timer = stats.time(cao::Stage::ArchiveWriting);
+        if (const bool success = std::move(archive).write(archive_path); !success)
+        {
+            PLOGE << "Failed to write archive " << archive_path.string();
+            return {};
+        }
+
+        std::error_code ec;
+        const auto size = btu::fs::file_size(archive_path, ec);
+        timer.set_bytes_out(ec ? 0 : size);
+    }
+
+    // we open the archive again to make sure the files are written
+    const bool valid = [&] {
+        auto timer = stats.time(cao::Stage::ArchiveVerification);
+        switch (verification)
+        {
+            case ArchiveVerification::Header:
+                return has_valid_archive_header(archive_path, relative_paths.size());
+            case ArchiveVerification::Full:
+            {
+                const auto written_archive = btu::bsa::Archive::read(archive_path);
+                return written_archive.has_value()
+                       && static_cast<size_t>(flux::from_range(*written_archive).count())
+                              == relative_paths.size();
+            }
+        }
+        return false;
+    }();
+
+    if (!valid)
+    {
+        PLOGE << "Archive was written but failed verification, it is likely corrupted. Removing it.";
+        std::error_code ec;
+        btu::fs::remove(archive_path, ec);
+        return {};
+    }
+
+    if (make_override)
+    {
+        const auto override_path = std::move(archive_path).replace_extension(".override");
+
+        btu::common::write_file_new(override_path, {}).map_error([](const btu::common::Error &e) {
+            if (e == std::errc::file_exists)
+                return; // this is fine
+
+            PLOGE << "Failed to create override file: " << e;
+        });
+    }
+
+    return relative_paths;
+}
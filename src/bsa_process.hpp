@@ -1,10 +1,37 @@
-#pragma once
-
-#include <btu/bsa/archive.hpp>
-#include <btu/bsa/settings.hpp>
-
-void write_single_archive(const btu::Path &directory_path,
-                          btu::bsa::Archive &&archive,
-                          const btu::bsa::Settings &bsa_sets,
-                          const bool remove_files,
-                          const bool make_override);
+#pragma once
+
+#include "statistics.hpp"
+
+#include <btu/bsa/archive.hpp>
+#include <btu/bsa/settings.hpp>
+
+#include <span>
+#include <vector>
+
+enum class ArchiveVerification : std::uint8_t
+{
+    /// Only check the header: the file count and the size of the index it describes
+    Header,
+    /// Read the whole archive index back and compare it with what was written
+    Full,
+};
+
+/**
+ * @brief Writes an archive next to the files it was made from
+ * @return The relative paths of the files stored in the archive, or nothing if it could not be written
+ */
+[[nodiscard]] auto write_single_archive(const btu::Path &directory_path,
+                                        btu::bsa::Archive &&archive,
+                                        const btu::bsa::Settings &bsa_sets,
+                                        ArchiveVerification verification,
+                                        bool make_override,
+                                        cao::RunStatistics &stats) -> std::vector<btu::Path>;
+
+[[nodiscard]] auto group_overlapping_archives(std::span<const btu::Path> archives)
+    -> std::vector<std::vector<btu::Path>>;
+
+[[nodiscard]] auto has_valid_archive_header(const btu::Path &archive_path, size_t expected_files) noexcept
+    -> bool;
+
+auto remove_files_from_directory(const btu::Path &directory, std::span<const btu::Path> paths) noexcept
+    -> size_t;
@@ -0,0 +1,170 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "cli.hpp"
+
+#include "gui/utils/utils.hpp"
+#include "manager.hpp"
+
+#include <btu/common/string.hpp>
+#include <nlohmann/json.hpp>
+#include <plog/Log.h>
+
+#include <QCommandLineParser>
+
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+namespace cao {
+namespace {
+// Only lock-free atomics can be touched from a signal handler
+std::atomic_bool g_stop_signal_received = false;
+static_assert(std::atomic_bool::is_always_lock_free);
+
+extern "C" void handle_stop_signal(int /*signal*/)
+{
+    g_stop_signal_received = true;
+}
+
+/// @brief Writes one JSON object per line. Lines can be written from any thread
+class JsonLinesWriter
+{
+public:
+    void write(const nlohmann::json &json)
+    {
+        const auto line = json.dump();
+
+        const auto lock = std::scoped_lock(mutex_);
+        std::cout << line << '\n' << std::flush;
+    }
+
+private:
+    std::mutex mutex_;
+};
+
+[[nodiscard]] auto parse_mode(const QString &mode) -> OptimizationMode
+{
+    if (mode == "single")
+        return OptimizationMode::SingleMod;
+    if (mode == "several")
+        return OptimizationMode::SeveralMods;
+
+    throw std::runtime_error("Invalid mode. Expected 'single' or 'several'");
+}
+
+[[nodiscard]] auto parse_texture_encoder(const QString &encoder) -> TextureEncoder
+{
+    if (encoder == "device")
+        return TextureEncoder::Device;
+    if (encoder == "cpu")
+        return TextureEncoder::Cpu;
+
+    throw std::runtime_error("Invalid texture encoder. Expected 'device' or 'cpu'");
+}
+} // namespace
+
+void add_cli_options(QCommandLineParser &parser)
+{
+    parser.addOption({"cli", "Do not run the GUI"});
+    parser.addOption({"input", "Override the input path of the profile", "path"});
+    parser.addOption(
+        {"mode", "Override the optimization mode of the profile: 'single' or 'several'", "mode"});
+    parser.addOption({"dry-run", "Only log what would be done"});
+    parser.addOption({"texture-encoder",
+                      "Override the texture encoder of the profile: 'device', or 'cpu' to compress BC1 and "
+                      "BC7 on the CPU",
+                      "encoder"});
+    parser.addOption({"resume", "Skip the work already done by the previous run, if it was interrupted"});
+}
+
+auto run_cli(const QCommandLineParser &parser, Settings settings) -> int
+{
+    if (const auto profile_name = parser.positionalArguments().value(0); !profile_name.isEmpty())
+    {
+        if (!settings.set_current_profile(to_u8string(profile_name)))
+            throw std::runtime_error("Profile not found");
+    }
+
+    auto &profile = settings.current_profile();
+    if (parser.isSet("input"))
+        profile.input_path = to_u8string(parser.value("input"));
+    if (parser.isSet("mode"))
+        profile.optimization_mode = parse_mode(parser.value("mode"));
+    if (parser.isSet("dry-run"))
+        profile.dry_run = true;
+    if (parser.isSet("texture-encoder"))
+        profile.texture_encoder = parse_texture_encoder(parser.value("texture-encoder"));
+
+    if (profile.input_path.empty() || !btu::fs::exists(profile.input_path))
+        throw std::runtime_error("The input path does not exist");
+
+    PLOGI << "Running profile " << btu::common::as_ascii_string(settings.current_profile_name())
+          << " on " << profile.input_path.string();
+
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+
+    auto stop_source = std::stop_source{};
+
+    // request_stop is not signal safe, so the handler only sets a flag that is polled here
+    auto signal_watcher = std::jthread([&stop_source](std::stop_token watcher_token) {
+        using namespace std::chrono_literals;
+        while (!watcher_token.stop_requested())
+        {
+            if (g_stop_signal_received)
+            {
+                PLOGW << "Stop requested. Waiting for the current files to finish";
+                stop_source.request_stop();
+                return;
+            }
+            std::this_thread::sleep_for(100ms);
+        }
+    });
+
+    auto writer = JsonLinesWriter{};
+
+    cao::Manager manager;
+
+    // There is no event loop in CLI mode: signals have to be handled on the emitting thread
+    QObject::connect(
+        &manager,
+        &Manager::progress,
+        &manager,
+        [&](const cao::ProgressStatus &status) {
+            auto event = nlohmann::json{{"event", "progress"},
+                                        {"processed", status.files_done},
+                                        {"total", status.files_total},
+                                        {"bytes", status.bytes_done},
+                                        {"files_per_s", status.files_per_second},
+                                        {"path", btu::common::as_ascii_string(status.last_path.u8string())}};
+            if (status.eta)
+                event["eta_s"] = status.eta->count();
+            writer.write(event);
+        },
+        Qt::DirectConnection);
+
+    manager.run_optimization(std::move(settings),
+                             stop_source.get_token(),
+                             RunOptions{.resume = parser.isSet("resume")});
+
+    signal_watcher.request_stop();
+    signal_watcher.join();
+
+    const bool interrupted = stop_source.stop_requested();
+    const auto failures    = manager.failure_count();
+
+    writer.write({{"event", "end"}, {"failures", failures}, {"interrupted", interrupted}});
+
+    if (interrupted)
+        return k_exit_interrupted;
+    if (failures != 0)
+        return k_exit_failures;
+    return k_exit_success;
+}
+} // namespace cao
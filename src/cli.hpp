@@ -0,0 +1,27 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "settings/settings.hpp"
+
+class QCommandLineParser;
+
+namespace cao {
+/// Exit codes of the command line mode
+enum CliExitCode : int
+{
+    k_exit_success     = 0,
+    k_exit_error       = 1,
+    k_exit_failures    = 2,
+    k_exit_interrupted = 3,
+};
+
+void add_cli_options(QCommandLineParser &parser);
+
+/// @brief Runs the optimization without GUI, using the profile and overrides given on the command line.
+/// Progress is written to stdout as JSON lines, logs go to stderr.
+/// @return One of CliExitCode
+[[nodiscard]] auto run_cli(const QCommandLineParser &parser, Settings settings) -> int;
+} // namespace cao
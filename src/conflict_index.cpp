@@ -0,0 +1,145 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "conflict_index.hpp"
+
+#include "hash.hpp"
+#include "main_process.hpp"
+#include "parallel.hpp"
+
+#include <btu/bsa/archive.hpp>
+#include <btu/bsa/plugin.hpp>
+#include <btu/common/string.hpp>
+#include <fmt/format.h>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace cao {
+/// @brief Hash of a relative path, ignoring case and the kind of separators
+[[nodiscard]] auto conflict_key(const btu::Path &relative_path) -> uint64_t
+{
+    auto normalized = btu::common::to_lower(relative_path.lexically_normal().generic_u8string());
+    std::ranges::replace(normalized, u8'\\', u8'/');
+    return hash_string(btu::common::as_ascii_string(normalized));
+}
+
+[[nodiscard]] auto mod_key(const btu::Path &mod_path) -> std::u8string
+{
+    return btu::common::to_lower(mod_path.lexically_normal().generic_u8string());
+}
+
+struct ModFiles
+{
+    std::vector<uint64_t> loose;
+    std::vector<uint64_t> archived;
+};
+
+[[nodiscard]] auto list_mod_files(const btu::Path &mod_path, const btu::bsa::Settings &bsa_sets) -> ModFiles
+{
+    auto files = ModFiles{};
+
+    std::error_code ec;
+    for (const auto &entry : btu::fs::recursive_directory_iterator(mod_path, ec))
+        if (entry.is_regular_file(ec) && guess_file_type(entry.path()))
+            files.loose.emplace_back(conflict_key(entry.path().lexically_relative(mod_path)));
+
+    for (const auto &archive_path : btu::bsa::list_archive(mod_path, bsa_sets))
+    {
+        const auto archive = btu::bsa::Archive::read(archive_path);
+        if (!archive)
+        {
+            PLOGW << fmt::format("Could not list the content of {}, its files are not checked for conflicts",
+                                 archive_path.string());
+            continue;
+        }
+
+        for (const auto &[relative_path, file] : *archive)
+            if (guess_file_type(btu::Path(relative_path)))
+                files.archived.emplace_back(conflict_key(btu::Path(relative_path)));
+    }
+
+    return files;
+}
+
+auto ConflictIndex::build(std::span<const btu::Path> mods,
+                          const btu::bsa::Settings &bsa_sets,
+                          bool extract_archives,
+                          Executor &executor,
+                          size_t max_concurrency,
+                          std::stop_token stop_token) -> ConflictIndex
+{
+    struct Task
+    {
+        const btu::Path *mod_path;
+        ModFiles files;
+    };
+
+    auto tasks = std::vector<Task>{};
+    tasks.reserve(mods.size());
+    for (const auto &mod_path : mods)
+        tasks.emplace_back(Task{.mod_path = &mod_path, .files = {}});
+
+    // Each task owns its result, so no lock is needed
+    parallel_for_each(executor, Lane::Io, std::span(tasks), max_concurrency, stop_token, [&](Task &task) {
+        task.files = list_mod_files(*task.mod_path, bsa_sets);
+    });
+
+    // A partial index could let a lower priority mod win
+    if (stop_token.stop_requested())
+        return {};
+
+    auto index     = ConflictIndex{};
+    auto seen      = std::unordered_map<uint64_t, Winner>{};
+    auto contested = std::unordered_set<uint64_t>{};
+
+    // Later mods have a higher priority
+    for (uint32_t mod = 0; mod < tasks.size(); ++mod)
+    {
+        index.mod_indices_.emplace(mod_key(*tasks[mod].mod_path), mod);
+
+        const auto add = [&](uint64_t key, bool loose) {
+            const auto [it, inserted] = seen.try_emplace(key, Winner{.mod = mod, .loose = loose});
+            if (inserted)
+                return;
+
+            if (it->second.mod != mod)
+                contested.insert(key);
+
+            // An archived file cannot hide a loose one, whatever its priority
+            if (loose || !it->second.loose)
+                it->second = Winner{.mod = mod, .loose = loose};
+        };
+
+        for (const auto key : tasks[mod].files.archived)
+            add(key, /*loose=*/extract_archives);
+        for (const auto key : tasks[mod].files.loose)
+            add(key, /*loose=*/true);
+
+        tasks[mod].files = {};
+    }
+
+    // Most files come from a single mod, they are not worth keeping
+    index.winners_.reserve(contested.size());
+    for (const auto key : contested)
+        index.winners_.emplace(key, seen.at(key));
+
+    return index;
+}
+
+auto ConflictIndex::is_overridden(const btu::Path &mod_path, const btu::Path &relative_path) const -> bool
+{
+    if (winners_.empty())
+        return false;
+
+    const auto mod = mod_indices_.find(mod_key(mod_path));
+    if (mod == mod_indices_.end())
+        return false;
+
+    const auto winner = winners_.find(conflict_key(relative_path));
+    return winner != winners_.end() && winner->second.mod != mod->second;
+}
+} // namespace cao
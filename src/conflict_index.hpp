@@ -0,0 +1,52 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "executor.hpp"
+
+#include <btu/bsa/settings.hpp>
+#include <btu/common/path.hpp>
+
+#include <span>
+#include <stop_token>
+#include <string>
+#include <unordered_map>
+
+namespace cao {
+/// @brief Which mod provides the copy the game loads, for each file provided by several mods.
+/// Loose files override archived ones, then the mod with the highest priority wins.
+/// Archives are really ordered by the load order of their plugins, mod priority is used instead
+class ConflictIndex
+{
+public:
+    /// @brief Lists the files of every mod, including the content of their archives.
+    /// Only files CAO can process are indexed
+    /// @param mods Lowest priority first
+    /// @param extract_archives Whether the archives are going to be extracted, making their files loose
+    [[nodiscard]] static auto build(std::span<const btu::Path> mods,
+                                    const btu::bsa::Settings &bsa_sets,
+                                    bool extract_archives,
+                                    Executor &executor,
+                                    size_t max_concurrency,
+                                    std::stop_token stop_token) -> ConflictIndex;
+
+    /// @brief Whether the copy of `relative_path` provided by `mod_path` is hidden by another mod
+    [[nodiscard]] auto is_overridden(const btu::Path &mod_path, const btu::Path &relative_path) const -> bool;
+
+    /// @brief Number of files provided by several mods
+    [[nodiscard]] auto size() const noexcept -> size_t { return winners_.size(); }
+
+private:
+    struct Winner
+    {
+        uint32_t mod;
+        bool loose;
+    };
+
+    std::unordered_map<std::u8string, uint32_t> mod_indices_;
+    /// Keyed by the hash of the normalized relative path. Files provided by a single mod are left out
+    std::unordered_map<uint64_t, Winner> winners_;
+};
+} // namespace cao
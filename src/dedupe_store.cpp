@@ -0,0 +1,106 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "dedupe_store.hpp"
+
+#include <chrono>
+#include <utility>
+
+namespace cao {
+DedupeStore::DedupeStore(uint64_t max_bytes) noexcept
+    : max_bytes_(max_bytes)
+{
+}
+
+DedupeStore::Claim::Claim(DedupeStore &store, uint64_t key, std::promise<Result> promise) noexcept
+    : store_(&store)
+    , key_(key)
+    , promise_(std::move(promise))
+{
+}
+
+DedupeStore::Claim::Claim(Claim &&other) noexcept
+    : store_(std::exchange(other.store_, nullptr))
+    , key_(other.key_)
+    , promise_(std::move(other.promise_))
+{
+}
+
+DedupeStore::Claim::~Claim()
+{
+    // The waiting files get a broken promise
+    if (store_ != nullptr)
+        store_->abandon(key_);
+}
+
+void DedupeStore::Claim::publish(std::span<const std::byte> output)
+{
+    if (store_ == nullptr)
+        return;
+
+    const auto [keep, waited_for] = [&] {
+        const auto lock = std::scoped_lock(store_->mutex_);
+
+        // The entry cannot be removed while it is claimed
+        const auto it     = store_->entries_.find(key_);
+        const bool waited = it->second.waiters > 0;
+        const bool fits   = store_->stored_bytes_ + output.size() <= store_->max_bytes_;
+
+        if (fits)
+            store_->stored_bytes_ += output.size();
+        else
+            store_->entries_.erase(it); // later files with this key are processed again
+
+        return std::pair{fits, waited};
+    }();
+
+    store_ = nullptr;
+
+    // Copying is only worth it if someone is going to read the output
+    auto result = Result{};
+    if (keep || waited_for)
+        result.output = std::make_shared<const std::vector<std::byte>>(output.begin(), output.end());
+
+    promise_.set_value(std::move(result));
+}
+
+void DedupeStore::Claim::publish_unchanged(bool failed)
+{
+    if (store_ == nullptr)
+        return;
+
+    store_ = nullptr;
+    promise_.set_value(Result{.output = nullptr, .failed = failed});
+}
+
+auto DedupeStore::acquire(uint64_t key) -> std::variant<Claim, std::shared_future<Result>>
+{
+    const auto lock = std::scoped_lock(mutex_);
+
+    if (const auto it = entries_.find(key); it != entries_.end())
+    {
+        auto &entry = it->second;
+        if (entry.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            ++entry.waiters;
+        return entry.result;
+    }
+
+    auto promise = std::promise<Result>();
+    entries_.emplace(key, Entry{.result = promise.get_future().share()});
+    return Claim(*this, key, std::move(promise));
+}
+
+auto DedupeStore::stored_bytes() const noexcept -> uint64_t
+{
+    const auto lock = std::scoped_lock(mutex_);
+    return stored_bytes_;
+}
+
+void DedupeStore::abandon(uint64_t key)
+{
+    const auto lock = std::scoped_lock(mutex_);
+    entries_.erase(key);
+}
+} // namespace cao
@@ -0,0 +1,81 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace cao {
+/// @brief Outputs of the files processed during a run, so identical files found in other mods are only
+/// processed once. Keys are computed like the file cache ones.
+/// Files that arrive while an identical one is being processed wait for its result instead of redoing it.
+class DedupeStore
+{
+public:
+    /// @brief What became of the first file with a given key
+    struct Result
+    {
+        /// Null if the file was left as is
+        std::shared_ptr<const std::vector<std::byte>> output;
+        bool failed = false;
+    };
+
+    /// @param max_bytes Outputs are kept until their total size reaches this
+    explicit DedupeStore(uint64_t max_bytes) noexcept;
+
+    /// @brief Right to process the first file with a key. Files with the same key wait until it publishes.
+    /// If it is destroyed without publishing, they are processed on their own
+    class Claim
+    {
+    public:
+        Claim(DedupeStore &store, uint64_t key, std::promise<Result> promise) noexcept;
+
+        Claim(const Claim &)                     = delete;
+        auto operator=(const Claim &) -> Claim & = delete;
+
+        Claim(Claim &&other) noexcept;
+        auto operator=(Claim &&) -> Claim & = delete;
+
+        ~Claim();
+
+        void publish(std::span<const std::byte> output);
+        void publish_unchanged(bool failed);
+
+    private:
+        DedupeStore *store_;
+        uint64_t key_;
+        std::promise<Result> promise_;
+    };
+
+    /// @brief Claims `key` if no file with this key was seen yet, or gives the result of the one that was
+    [[nodiscard]] auto acquire(uint64_t key) -> std::variant<Claim, std::shared_future<Result>>;
+
+    /// @brief Size of the outputs currently kept
+    [[nodiscard]] auto stored_bytes() const noexcept -> uint64_t;
+
+private:
+    struct Entry
+    {
+        std::shared_future<Result> result;
+        /// Files that got `result` before it was published
+        size_t waiters = 0;
+    };
+
+    void abandon(uint64_t key);
+
+    uint64_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Entry> entries_;
+    uint64_t stored_bytes_ = 0;
+};
+} // namespace cao
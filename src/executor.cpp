@@ -0,0 +1,172 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "executor.hpp"
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace cao {
+class Executor::Pool
+{
+public:
+    explicit Pool(size_t thread_count)
+    {
+        thread_count = std::max(thread_count, size_t{1});
+
+        queues_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i)
+            queues_.emplace_back(std::make_unique<Queue>());
+
+        threads_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i)
+            threads_.emplace_back([this, i](std::stop_token stop_token) { run(stop_token, i); });
+    }
+
+    Pool(const Pool &)                     = delete;
+    auto operator=(const Pool &) -> Pool & = delete;
+
+    Pool(Pool &&)                     = delete;
+    auto operator=(Pool &&) -> Pool & = delete;
+
+    /// Pending tasks are run before the threads exit
+    ~Pool()
+    {
+        for (auto &thread : threads_)
+            thread.request_stop();
+        wake_.notify_all();
+        threads_.clear();
+    }
+
+    void submit(std::function<void()> task)
+    {
+        // Tasks spawned by a task of this pool are likely to use the same data, keep them on the same thread
+        const auto index = current_pool_ == this ? current_queue_
+                                                 : next_queue_.fetch_add(1, std::memory_order_relaxed)
+                                                       % queues_.size();
+        // Counted before it is visible, so a thread taking it right away cannot make the count wrap around
+        {
+            const auto lock = std::scoped_lock(wake_mutex_);
+            ++pending_;
+        }
+        {
+            auto &queue     = *queues_[index];
+            const auto lock = std::scoped_lock(queue.mutex);
+            queue.tasks.emplace_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+    [[nodiscard]] auto size() const noexcept -> size_t { return threads_.size(); }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    /// @brief Takes the newest task of the thread's own queue, or else the oldest task of another queue
+    [[nodiscard]] auto pop(size_t index) -> std::optional<std::function<void()>>
+    {
+        const auto take = [this](Queue &queue, bool newest) -> std::optional<std::function<void()>> {
+            const auto lock = std::scoped_lock(queue.mutex);
+            if (queue.tasks.empty())
+                return std::nullopt;
+
+            auto task = newest ? std::move(queue.tasks.back()) : std::move(queue.tasks.front());
+            if (newest)
+                queue.tasks.pop_back();
+            else
+                queue.tasks.pop_front();
+
+            const auto wake_lock = std::scoped_lock(wake_mutex_);
+            --pending_;
+            return task;
+        };
+
+        if (auto task = take(*queues_[index], true))
+            return task;
+
+        for (size_t offset = 1; offset < queues_.size(); ++offset)
+            if (auto task = take(*queues_[(index + offset) % queues_.size()], false))
+                return task;
+
+        return std::nullopt;
+    }
+
+    void run(std::stop_token stop_token, size_t index)
+    {
+        current_pool_  = this;
+        current_queue_ = index;
+
+        while (true)
+        {
+            if (auto task = pop(index))
+            {
+                try
+                {
+                    (*task)();
+                }
+                catch (const std::exception &e)
+                {
+                    PLOGE << "Unhandled exception in a background task: " << e.what();
+                }
+                catch (...)
+                {
+                    PLOGE << "Unhandled unknown exception in a background task";
+                }
+                continue;
+            }
+
+            auto lock = std::unique_lock(wake_mutex_);
+            wake_.wait(lock, stop_token, [this] { return pending_ > 0; });
+            if (stop_token.stop_requested() && pending_ == 0)
+                return;
+        }
+    }
+
+    static thread_local const Pool *current_pool_;
+    static thread_local size_t current_queue_;
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::atomic_size_t next_queue_{0};
+
+    std::mutex wake_mutex_;
+    std::condition_variable_any wake_;
+    size_t pending_ = 0;
+
+    std::vector<std::jthread> threads_;
+};
+
+thread_local const Executor::Pool *Executor::Pool::current_pool_ = nullptr;
+thread_local size_t Executor::Pool::current_queue_               = 0;
+
+Executor::Executor(size_t cpu_threads, size_t io_threads)
+    : pools_{std::make_unique<Pool>(cpu_threads), std::make_unique<Pool>(io_threads)}
+{
+}
+
+Executor::~Executor() = default;
+
+void Executor::submit(Lane lane, std::function<void()> task)
+{
+    pools_[static_cast<size_t>(lane)]->submit(std::move(task));
+}
+
+auto Executor::thread_count(Lane lane) const noexcept -> size_t
+{
+    return pools_[static_cast<size_t>(lane)]->size();
+}
+} // namespace cao
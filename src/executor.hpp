@@ -0,0 +1,59 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+namespace cao {
+/// @brief Kind of work a task mostly does. Each lane has its own threads, so tasks waiting on the disk
+/// do not hold threads needed by computations, and the other way around
+enum class Lane : std::uint8_t
+{
+    Cpu,
+    Io,
+};
+
+/// @brief Work-stealing thread pool shared by all the stages of a run.
+/// Each thread has its own queue. Tasks submitted from a thread of the pool go to its queue, and idle
+/// threads steal from the others.
+class Executor
+{
+public:
+    Executor(size_t cpu_threads, size_t io_threads);
+    ~Executor();
+
+    Executor(const Executor &)                     = delete;
+    auto operator=(const Executor &) -> Executor & = delete;
+
+    Executor(Executor &&)                     = delete;
+    auto operator=(Executor &&) -> Executor & = delete;
+
+    /// @brief Runs `task` on a thread of `lane`. Exceptions thrown by `task` are logged and ignored
+    void submit(Lane lane, std::function<void()> task);
+
+    /// @brief Runs `func` on a thread of `lane`, and gives access to its result or exception
+    template<typename Func>
+    [[nodiscard]] auto async(Lane lane, Func func) -> std::future<std::invoke_result_t<Func>>
+    {
+        // std::function needs a copyable callable
+        auto task   = std::make_shared<std::packaged_task<std::invoke_result_t<Func>()>>(std::move(func));
+        auto future = task->get_future();
+        submit(lane, [task = std::move(task)] { (*task)(); });
+        return future;
+    }
+
+    [[nodiscard]] auto thread_count(Lane lane) const noexcept -> size_t;
+
+    class Pool;
+
+private:
+    std::array<std::unique_ptr<Pool>, 2> pools_;
+};
+} // namespace cao
@@ -0,0 +1,156 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "file_cache.hpp"
+
+#include "hash.hpp"
+#include "version.hpp"
+
+#include <nlohmann/json.hpp>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace cao {
+FileCache::FileCache(std::filesystem::path file_path)
+    : file_path_(std::move(file_path))
+{
+    std::ifstream stream(file_path_, std::ios::binary);
+    if (!stream)
+        return;
+
+    try
+    {
+        const auto json = nlohmann::json::from_msgpack(std::istreambuf_iterator<char>(stream),
+                                                       std::istreambuf_iterator<char>());
+
+        generation_ = json.at("generation").get<uint32_t>() + 1;
+
+        const auto &keys        = json.at("keys").get_ref<const nlohmann::json::array_t &>();
+        const auto &generations = json.at("generations").get_ref<const nlohmann::json::array_t &>();
+        if (keys.size() != generations.size())
+            throw std::runtime_error("keys and generations do not match");
+
+        entries_.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+            entries_.try_emplace(keys[i].get<uint64_t>(), generations[i].get<uint32_t>());
+    }
+    catch (const std::exception &e)
+    {
+        PLOGW << "Ignoring unreadable file cache " << file_path_.string() << ": " << e.what();
+        entries_.clear();
+    }
+}
+
+auto FileCache::contains(uint64_t key) noexcept -> bool
+{
+    const auto lock = std::shared_lock(mutex_);
+
+    const auto it = entries_.find(key);
+    if (it == entries_.end())
+        return false;
+
+    // Only the value of the entry changes, so the shared lock is enough
+    it->second.store(generation_, std::memory_order_relaxed);
+    return true;
+}
+
+void FileCache::insert(uint64_t key)
+{
+    const auto lock           = std::unique_lock(mutex_);
+    const auto [it, inserted] = entries_.try_emplace(key, generation_);
+    if (!inserted)
+        it->second.store(generation_, std::memory_order_relaxed);
+}
+
+auto FileCache::size() const noexcept -> size_t
+{
+    const auto lock = std::shared_lock(mutex_);
+    return entries_.size();
+}
+
+auto FileCache::save() const -> bool
+{
+    const auto save_lock = std::scoped_lock(save_mutex_);
+
+    // Entries are copied, so the lock is not held while pruning and serializing
+    auto kept = [this] {
+        const auto lock = std::shared_lock(mutex_);
+
+        auto entries = std::vector<std::pair<uint64_t, uint32_t>>{};
+        entries.reserve(entries_.size());
+        for (const auto &[key, generation] : entries_)
+        {
+            const auto last_used = generation.load(std::memory_order_relaxed);
+            if (last_used + k_max_unused_runs >= generation_)
+                entries.emplace_back(key, last_used);
+        }
+        return entries;
+    }();
+
+    if (kept.size() > k_max_entries)
+    {
+        const auto most_recent_first = [](const auto &lhs, const auto &rhs) {
+            return lhs.second > rhs.second;
+        };
+        std::ranges::nth_element(kept, kept.begin() + k_max_entries, most_recent_first);
+        kept.resize(k_max_entries);
+    }
+
+    auto keys        = nlohmann::json::array();
+    auto generations = nlohmann::json::array();
+    for (const auto &[key, generation] : kept)
+    {
+        keys.push_back(key);
+        generations.push_back(generation);
+    }
+
+    const auto bytes = nlohmann::json::to_msgpack(nlohmann::json{
+        {"generation", generation_},
+        {"keys", std::move(keys)},
+        {"generations", std::move(generations)},
+    });
+
+    // Write to a temporary file first, so a crash cannot leave a truncated cache behind
+    auto temp_path = file_path_;
+    temp_path += ".tmp";
+    {
+        std::ofstream stream(temp_path, std::ios::binary | std::ios::trunc);
+        if (!stream)
+            return false;
+
+        stream.write(reinterpret_cast<const char *>(bytes.data()),
+                     static_cast<std::streamsize>(bytes.size()));
+        if (!stream)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, file_path_, ec);
+    return !ec;
+}
+
+auto FileCache::make_key(std::span<const std::byte> content, uint64_t settings_fingerprint) noexcept
+    -> uint64_t
+{
+    return hash_combine(hash_bytes(content), settings_fingerprint);
+}
+
+auto settings_fingerprint(const PerFileSettings &settings, TextureEncoder encoder) -> uint64_t
+{
+    auto json = nlohmann::json(settings);
+
+    // The device encoder has a single effort level
+    if (encoder != TextureEncoder::Cpu)
+        json.erase("tex_compression_tier");
+
+    const auto seed = hash_combine(hash_string(k_cao_version), static_cast<uint64_t>(encoder));
+    return hash_combine(seed, hash_string(json.dump()));
+}
+} // namespace cao
@@ -0,0 +1,59 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "settings/per_file_settings.hpp"
+#include "settings/profile.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace cao {
+/// @brief Persistent set of files known to need no more work.
+/// A key combines the hash of a file content with the fingerprint of the settings it was processed with.
+/// Files whose key is in the cache can be skipped without being parsed.
+/// Each entry remembers the last run that used it, so entries unused for a while are dropped when saving.
+class FileCache
+{
+public:
+    /// @brief Loads the cache stored at `file_path`. A missing or unreadable file gives an empty cache.
+    explicit FileCache(std::filesystem::path file_path);
+
+    /// @brief Whether `key` is in the cache. Marks it as used by the current run
+    [[nodiscard]] auto contains(uint64_t key) noexcept -> bool;
+    void insert(uint64_t key);
+
+    /// @brief Writes the cache to disk, without the entries unused for `k_max_unused_runs` runs.
+    /// At most `k_max_entries` are kept, the most recently used ones.
+    /// Can be called while other threads insert
+    [[nodiscard]] auto save() const -> bool;
+
+    [[nodiscard]] auto size() const noexcept -> size_t;
+
+    [[nodiscard]] static auto make_key(std::span<const std::byte> content,
+                                       uint64_t settings_fingerprint) noexcept -> uint64_t;
+
+    static constexpr auto k_file_name           = "file_cache.msgpack";
+    static constexpr uint32_t k_max_unused_runs = 10;
+    static constexpr size_t k_max_entries       = size_t{4} * 1024 * 1024;
+
+private:
+    std::filesystem::path file_path_;
+    /// Incremented by each run that loads the cache
+    uint32_t generation_ = 0;
+
+    mutable std::shared_mutex mutex_;
+    mutable std::mutex save_mutex_;
+    /// Key to the generation of the last run that used it. Updated under a shared lock by `contains`
+    std::unordered_map<uint64_t, std::atomic_uint32_t> entries_;
+};
+
+/// @brief Identifies the effective settings a file is processed with, including the CAO version and the
+/// texture encoder. Settings the encoder ignores are left out
+[[nodiscard]] auto settings_fingerprint(const PerFileSettings &settings, TextureEncoder encoder) -> uint64_t;
+} // namespace cao
@@ -20,7 +20,11 @@ AdvancedTexturesModule::AdvancedTexturesModule(QWidget *parent)
 {
     ui_->setupUi(this);
 
-    connect_group_box(ui_->mainBox, ui_->mainCompress, ui_->mainMipMaps);
+    connect_group_box(ui_->mainBox, ui_->mainCompress, ui_->mainMipMaps, ui_->mainCompressionTier);
+
+    set_data(*ui_->mainCompressionTier, "Fast", CompressionTier::Fast);
+    set_data(*ui_->mainCompressionTier, "Balanced", CompressionTier::Balanced);
+    set_data(*ui_->mainCompressionTier, "Max", CompressionTier::Max);
 
     connect_group_box(ui_->resizingBox,
                       ui_->resizingMode,
@@ -87,6 +91,13 @@ void AdvancedTexturesModule::settings_to_ui(const Settings &settings)
     ui_->mainBox->setChecked(pfs.tex_optimize != OptimizeType::None);
     ui_->mainCompress->setChecked(pfs.tex.compress);
     ui_->mainMipMaps->setChecked(pfs.tex.mipmaps);
+    [[maybe_unused]] const bool tier_found = select_data(*ui_->mainCompressionTier, pfs.tex_compression_tier);
+    assert(tier_found);
+
+    // Only the CPU encoder has several effort levels
+    const bool has_tiers = settings.current_profile().texture_encoder == TextureEncoder::Cpu;
+    ui_->mainCompressionTierLabel->setVisible(has_tiers);
+    ui_->mainCompressionTier->setVisible(has_tiers);
 
     // Resizing
     ui_->resizingBox->setChecked(true);
@@ -126,6 +137,8 @@ void AdvancedTexturesModule::ui_to_settings(Settings &settings) const
     pfs.tex.compress = ui_->mainCompress->isChecked();
     pfs.tex.mipmaps  = ui_->mainMipMaps->isChecked();
 
+    pfs.tex_compression_tier = ui_->mainCompressionTier->currentData().value<CompressionTier>();
+
     // Resizing
     pfs.tex.resize = std::monostate{};
     if (ui_->resizingBox->isChecked())
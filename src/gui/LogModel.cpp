@@ -0,0 +1,106 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "LogModel.hpp"
+
+#include <QBrush>
+#include <QColor>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+namespace cao {
+[[nodiscard]] auto log_color(plog::Severity severity) noexcept -> const char *
+{
+    switch (severity)
+    {
+        case plog::none: break;
+        case plog::fatal: return "DarkRed";
+        case plog::error: return "Red";
+        case plog::warning: return "Orange";
+        case plog::info: return "Green";
+        case plog::debug: return "Blue";
+        case plog::verbose: return "Purple";
+    }
+    return "Black";
+}
+
+LogModel::LogModel(int max_entries, QObject *parent)
+    : QAbstractListModel(parent)
+    , max_entries_(std::max(max_entries, 1))
+{
+}
+
+auto LogModel::rowCount(const QModelIndex &parent) const -> int
+{
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(entries_.size());
+}
+
+auto LogModel::data(const QModelIndex &index, int role) const -> QVariant
+{
+    if (!index.isValid() || index.row() >= rowCount())
+        return {};
+
+    const auto &entry = entries_[static_cast<size_t>(index.row())];
+    switch (role)
+    {
+        case Qt::DisplayRole: return entry.text;
+        case Qt::ForegroundRole: return QBrush(QColor(log_color(entry.severity)));
+        case k_severity_role: return QVariant::fromValue(entry.severity);
+        default: return {};
+    }
+}
+
+void LogModel::append(std::vector<LogEntry> entries)
+{
+    if (entries.empty())
+        return;
+
+    // Entries that would be removed right away are not inserted at all
+    const auto max_entries = static_cast<size_t>(max_entries_);
+    if (entries.size() > max_entries)
+        entries.erase(entries.begin(), entries.end() - static_cast<std::ptrdiff_t>(max_entries));
+
+    const auto overflow = entries_.size() + entries.size() > max_entries
+                              ? entries_.size() + entries.size() - max_entries
+                              : 0;
+    if (overflow > 0)
+    {
+        beginRemoveRows(QModelIndex(), 0, static_cast<int>(overflow) - 1);
+        entries_.erase(entries_.begin(), entries_.begin() + static_cast<std::ptrdiff_t>(overflow));
+        endRemoveRows();
+    }
+
+    const auto first = static_cast<int>(entries_.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(entries.size()) - 1);
+    std::move(entries.begin(), entries.end(), std::back_inserter(entries_));
+    endInsertRows();
+}
+
+void LogModel::clear()
+{
+    beginResetModel();
+    entries_.clear();
+    endResetModel();
+}
+
+void LogSeverityFilter::set_max_severity(plog::Severity severity)
+{
+    if (severity == max_severity_)
+        return;
+
+    max_severity_ = severity;
+    invalidateRowsFilter();
+}
+
+auto LogSeverityFilter::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const -> bool
+{
+    const auto index = sourceModel()->index(source_row, 0, source_parent);
+    return sourceModel()->data(index, LogModel::k_severity_role).value<plog::Severity>() <= max_severity_;
+}
+} // namespace cao
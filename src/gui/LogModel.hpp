@@ -0,0 +1,54 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "log_buffer.hpp"
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+
+#include <deque>
+
+Q_DECLARE_METATYPE(plog::Severity)
+
+namespace cao {
+/// @brief The last log entries, oldest first
+class LogModel final : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    static constexpr int k_severity_role = Qt::UserRole;
+
+    explicit LogModel(int max_entries, QObject *parent = nullptr);
+
+    [[nodiscard]] auto rowCount(const QModelIndex &parent = QModelIndex()) const -> int override;
+    [[nodiscard]] auto data(const QModelIndex &index, int role = Qt::DisplayRole) const -> QVariant override;
+
+    /// @brief Adds entries at the end, removing the oldest ones past the maximum
+    void append(std::vector<LogEntry> entries);
+    void clear();
+
+private:
+    int max_entries_;
+    std::deque<LogEntry> entries_;
+};
+
+/// @brief Hides the entries less severe than a given level
+class LogSeverityFilter final : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    using QSortFilterProxyModel::QSortFilterProxyModel;
+
+    void set_max_severity(plog::Severity severity);
+
+protected:
+    [[nodiscard]] auto filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+        -> bool override;
+
+private:
+    plog::Severity max_severity_ = plog::info;
+};
+} // namespace cao
@@ -136,7 +136,6 @@ void ui_to_settings(const Ui::MainWindow &ui, const ModuleDisplay &module_displa
 
     settings.current_profile().input_path        = ui.inputDirTextEdit->text().toStdString();
     settings.current_profile().dry_run           = ui.dryRunCheckBox->isChecked();
-    settings.current_profile().mods_blacklist    = {}; // TODO
     settings.current_profile().optimization_mode = ui.modeChooserComboBox->currentData()
                                                        .value<OptimizationMode>();
 
@@ -368,20 +367,25 @@ void MainWindow::init_process()
 
     try
     {
-        progress_window_ = std::make_unique<ProgressWindow>(
-            LogReader(Settings::state_directory() / k_log_file_name));
+        progress_window_ = std::make_unique<ProgressWindow>(Settings::state_directory() / k_log_file_name);
 
         cao_process_ = std::jthread([this](std::stop_token &&stop_token) mutable {
             auto manager = Manager();
 
-            connect(&manager, &Manager::files_counted, progress_window_.get(), &ProgressWindow::set_maximum);
-
             connect(&manager,
-                    &Manager::files_processed,
+                    &Manager::progress,
                     progress_window_.get(),
-                    [this](const std::filesystem::path &file, size_t count_since_last) {
-                        const auto text = QString("Processing %1").arg(QString::fromStdString(file.string()));
-                        progress_window_->step(std::optional(text), static_cast<int>(count_since_last));
+                    [this](const ProgressStatus &status) {
+                        auto text = QString("Processing %1 (%2 files/s")
+                                        .arg(QString::fromStdString(status.last_path.string()))
+                                        .arg(status.files_per_second, 0, 'f', 1);
+                        if (status.eta)
+                            text += QString(", %1 s left").arg(status.eta->count());
+                        text += ')';
+
+                        const auto done_since_last = static_cast<int>(status.files_since_last);
+                        progress_window_->set_maximum(static_cast<int>(status.files_total));
+                        progress_window_->step(std::optional(text), done_since_last);
                     });
 
             connect(&manager, &Manager::end, progress_window_.get(), &ProgressWindow::end);
@@ -5,6 +5,7 @@
 
 #include "ProgressWindow.hpp"
 
+#include "logger.hpp"
 #include "ui_ProgressWindow.h"
 #include "utils/utils.hpp"
 
@@ -13,113 +14,28 @@
 
 #include <QCloseEvent>
 #include <QDesktopServices>
-#include <QFile>
-#include <QTextStream>
 #include <utility>
 
 namespace cao {
 
 constexpr int k_max_log_entries = 5000;
 
-LogReader::LogReader(btu::Path log_file_path)
-    : log_file_path_(BTU_MOV(log_file_path))
-{
-}
-
-auto LogReader::update() -> std::vector<LogEntry>
-{
-    // We have to reopen the file every time because it can be rotated
-    QFile log_file(log_file_path_);
-    log_file.open(QFile::ReadOnly);
-
-    if (!log_file.isOpen())
-        return {{QString("Failed to open log file: %1").arg(QString::fromStdString(log_file_path_.string())),
-                 plog::error}};
-
-    auto log_stream = QTextStream(&log_file);
-    advance_to_last_read(log_stream);
-
-    auto entries = std::vector<LogEntry>{};
-
-    while (!log_stream.atEnd())
-        entries.emplace_back(read_line(log_stream));
-
-    update_last_read(log_stream);
-
-    return entries;
-}
-
-auto LogReader::get_log_path() const noexcept -> btu::Path
-{
-    return log_file_path_;
-}
-
-auto LogReader::read_line(QTextStream &log_stream) -> LogEntry
-{
-    constexpr char log_line_end = '|';
-
-    QString log_line = log_stream.readLine();
-    log_line.reserve(1000);
-
-    while (true)
-    {
-        if (log_stream.atEnd())
-            break;
-
-        if (log_line.endsWith(log_line_end))
-        {
-            log_line.chop(1); // Remove `log_line_end`
-            break;
-        }
-
-        log_line.append(log_stream.readLine());
-    }
-    return LogEntry(BTU_MOV(log_line));
-}
-
-void LogReader::update_last_read(QTextStream &ts)
-{
-    log_read_pos_ = ts.pos();
-}
-
-void LogReader::advance_to_last_read(QTextStream &log_stream)
-{
-    auto first = log_stream.readLine();
-
-    if (first != current_file_first_line_) // Current and previous file are not the same
-    {
-        current_file_first_line_ = std::move(first);
-        log_read_pos_            = 0;
-    }
-
-    log_stream.seek(log_read_pos_);
-}
-
-LogReader::LogEntry::LogEntry(QString line)
-    : text(BTU_MOV(line))
-{
-    // We know our CustomFormatter is used. Time always uses the same number of chars, 24
-    constexpr int time_length = 24;
-    const auto level_end      = text.indexOf(' ', time_length) - time_length;
-    const auto line_severity  = text.mid(time_length, level_end);
-
-    severity = plog::severityFromString(qPrintable(line_severity));
-}
-LogReader::LogEntry::LogEntry(QString line, plog::Severity severity)
-    : text(BTU_MOV(line))
-    , severity(severity)
-{
-}
-
-ProgressWindow::ProgressWindow(LogReader log_reader, QWidget *parent)
+ProgressWindow::ProgressWindow(btu::Path log_file_path, QWidget *parent)
     : QWidget(parent)
-    , log_reader_(BTU_MOV(log_reader))
+    , log_file_path_(BTU_MOV(log_file_path))
+    // Records logged before the window was opened belong to previous runs
+    , log_cursor_(log_buffer().end_cursor())
+    , log_model_(k_max_log_entries)
     , ui_(std::make_unique<Ui::ProgressWindow>())
 {
     ui_->setupUi(this);
     setWindowModality(Qt::WindowModal); // Prevents user from interacting with the main window
 
+    log_filter_.setSourceModel(&log_model_);
+    ui_->log->setModel(&log_filter_);
     ui_->log->setWordWrap(true);
+    // Lays out new rows in batches, so the window stays responsive when many records arrive at once
+    ui_->log->setLayoutMode(QListView::Batched);
 
     set_data(*ui_->logLevel, "Verbose", plog::verbose);
     set_data(*ui_->logLevel, "Info", plog::info);
@@ -128,15 +44,15 @@ ProgressWindow::ProgressWindow(LogReader log_reader, QWidget *parent)
     [[maybe_unused]] const bool res = select_data(*ui_->logLevel, plog::info); // Default to info
     assert(res);
 
-    connect(ui_->clearLog, &QPushButton::clicked, this, [this] { ui_->log->clear(); });
+    connect(ui_->clearLog, &QPushButton::clicked, this, [this] { log_model_.clear(); });
 
     connect(ui_->openLogFile, &QPushButton::clicked, this, [this] {
-        const auto path = to_qstring(btu::fs::absolute(log_reader_.get_log_path()).u8string());
+        const auto path = to_qstring(btu::fs::absolute(log_file_path_).u8string());
         QDesktopServices::openUrl(QUrl("file:///" + path));
     });
 
     connect(ui_->logLevel, &QComboBox::currentIndexChanged, this, [this](int index) {
-        update_log(ui_->logLevel->itemData(index).value<plog::Severity>());
+        log_filter_.set_max_severity(ui_->logLevel->itemData(index).value<plog::Severity>());
     });
 
     timer_.setSingleShot(false);
@@ -182,7 +98,7 @@ void ProgressWindow::update_all()
     else
         ui_->progressBar->setValue(current_value_);
 
-    update_log(ui_->logLevel->itemData(ui_->logLevel->currentIndex()).value<plog::Severity>());
+    update_log();
 }
 
 void ProgressWindow::update_progress_bar(const QString &text, int max, int value)
@@ -193,45 +109,10 @@ void ProgressWindow::update_progress_bar(const QString &text, int max, int value
     progress_bar->setValue(value);
 }
 
-[[nodiscard]] auto log_color(plog::Severity severity) noexcept -> const char *
+void ProgressWindow::update_log()
 {
-    switch (severity)
-    {
-        case plog::none: break;
-        case plog::fatal: return "DarkRed";
-        case plog::error: return "Red";
-        case plog::warning: return "Orange";
-        case plog::info: return "Green";
-        case plog::debug: return "Blue";
-        case plog::verbose: return "Purple";
-    }
-    return "Black";
-}
-
-void ProgressWindow::update_log(plog::Severity log_severity)
-{
-    for (const auto &entry : log_reader_.update())
-    {
-        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
-        auto *item = new QListWidgetItem(entry.text);
-        item->setForeground(QBrush(QColor(log_color(entry.severity))));
-        item->setData(Qt::UserRole, QVariant::fromValue(entry.severity));
-        ui_->log->addItem(item);
-    }
-
-    for (int i = 0; i < ui_->log->count(); ++i)
-    {
-        auto *item      = ui_->log->item(i);
-        const bool hide = item->data(Qt::UserRole).value<plog::Severity>() > log_severity;
-        item->setHidden(hide);
-    }
-
-    if (ui_->log->count() > k_max_log_entries)
-    {
-        auto *model = ui_->log->model();
-        model->removeRows(0, k_max_log_entries / 2);
-    }
-
+    // Only the records written since the last update are copied, the filter only checks the new rows
+    log_model_.append(log_buffer().read_since(log_cursor_));
     ui_->log->scrollToBottom();
 }
 
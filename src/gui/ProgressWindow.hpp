@@ -5,62 +5,26 @@
 
 #pragma once
 
-#include "plog/Severity.h"
+#include "LogModel.hpp"
 
 #include <btu/common/path.hpp>
 
-#include <QFile>
-#include <QMetaType>
 #include <QProgressDialog>
 #include <QTimer>
 #include <QWidget>
 
 class QCloseEvent;
-class QTextStream;
 
 namespace Ui {
 class ProgressWindow;
 } // namespace Ui
 
-Q_DECLARE_METATYPE(plog::Severity)
-
 namespace cao {
-
-class LogReader
-{
-public:
-    struct LogEntry
-    {
-        explicit LogEntry(QString line);
-        LogEntry(QString line, plog::Severity severity);
-
-        QString text;
-        plog::Severity severity;
-    };
-
-    explicit LogReader(btu::Path log_file_path);
-
-    [[nodiscard]] auto update() -> std::vector<LogEntry>;
-
-    [[nodiscard]] auto get_log_path() const noexcept -> btu::Path;
-
-private:
-    void advance_to_last_read(QTextStream &log_stream);
-    void update_last_read(QTextStream &ts);
-
-    [[nodiscard]] static auto read_line(QTextStream &log_stream) -> LogEntry;
-
-    QString current_file_first_line_;
-    std::streampos log_read_pos_;
-
-    btu::Path log_file_path_;
-};
-
 class ProgressWindow final : public QWidget
 {
     Q_OBJECT
 public:
-    explicit ProgressWindow(LogReader log_reader, QWidget *parent = nullptr);
+    explicit ProgressWindow(btu::Path log_file_path, QWidget *parent = nullptr);
 
     ProgressWindow(const ProgressWindow &)                     = delete;
     auto operator=(const ProgressWindow &) -> ProgressWindow & = delete;
@@ -85,12 +49,16 @@ private:
     std::optional<QString> last_text_;
     QTimer timer_;
 
-    LogReader log_reader_;
+    btu::Path log_file_path_;
+    /// Sequence number of the next log record to read from the log buffer
+    uint64_t log_cursor_;
+    LogModel log_model_;
+    LogSeverityFilter log_filter_;
     std::unique_ptr<Ui::ProgressWindow> ui_;
 
     void update_all();
 
     void update_progress_bar(const QString &text, int max, int value);
-    void update_log(plog::Severity log_severity);
+    void update_log();
 };
 } // namespace cao
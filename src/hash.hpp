@@ -0,0 +1,74 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+namespace cao {
+/// @brief Final mixing step of splitmix64
+[[nodiscard]] constexpr auto mix_hash(uint64_t value) noexcept -> uint64_t
+{
+    value ^= value >> 30U;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27U;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31U;
+    return value;
+}
+
+[[nodiscard]] constexpr auto hash_combine(uint64_t seed, uint64_t value) noexcept -> uint64_t
+{
+    return mix_hash(seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6U) + (seed >> 2U)));
+}
+
+/// @brief Fast non-cryptographic 64 bits hash, used to recognize file contents.
+/// Reads 32 bytes per iteration into independent lanes, so it is mostly bound by memory bandwidth.
+[[nodiscard]] inline auto hash_bytes(std::span<const std::byte> data, uint64_t seed = 0) noexcept -> uint64_t
+{
+    constexpr uint64_t k_prime_1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t k_prime_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr size_t k_lanes     = 4;
+    constexpr size_t k_block     = k_lanes * sizeof(uint64_t);
+
+    auto lanes = std::array{seed + k_prime_1, seed + k_prime_2, seed, seed - k_prime_1};
+
+    const auto consume = [&lanes](const std::byte *block) {
+        for (size_t i = 0; i < k_lanes; ++i)
+        {
+            uint64_t word{};
+            std::memcpy(&word, block + i * sizeof(uint64_t), sizeof(uint64_t));
+            lanes[i] = std::rotl(lanes[i] + word * k_prime_2, 31) * k_prime_1;
+        }
+    };
+
+    size_t offset = 0;
+    for (; offset + k_block <= data.size(); offset += k_block)
+        consume(data.data() + offset);
+
+    if (offset < data.size())
+    {
+        auto tail = std::array<std::byte, k_block>{};
+        std::memcpy(tail.data(), data.data() + offset, data.size() - offset);
+        consume(tail.data());
+    }
+
+    auto result = static_cast<uint64_t>(data.size());
+    for (const auto lane : lanes)
+        result = hash_combine(result, lane);
+
+    return result;
+}
+
+[[nodiscard]] inline auto hash_string(std::string_view str, uint64_t seed = 0) noexcept -> uint64_t
+{
+    return hash_bytes(std::as_bytes(std::span(str)), seed);
+}
+} // namespace cao
@@ -0,0 +1,230 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "journal.hpp"
+
+#include <btu/common/string.hpp>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <plog/Log.h>
+
+#include <utility>
+
+namespace cao {
+constexpr auto k_kind_input            = "input";
+constexpr auto k_kind_mod_done         = "mod_done";
+constexpr auto k_kind_archives_packed  = "archives_packed";
+constexpr auto k_kind_file_transformed = "file_transformed";
+
+constexpr auto k_flush_interval = std::chrono::seconds(1);
+constexpr size_t k_flush_bytes  = 64 * 1024;
+
+[[nodiscard]] auto journal_key(const std::filesystem::path &path) -> std::string
+{
+    return btu::common::as_ascii_string(btu::common::to_lower(path.lexically_normal().generic_u8string()));
+}
+
+[[nodiscard]] auto file_journal_key(const std::filesystem::path &path, FileSource source) -> std::string
+{
+    switch (source)
+    {
+        case FileSource::Loose: return "loose:" + journal_key(path);
+        case FileSource::Archive: return "archive:" + journal_key(path);
+    }
+    return journal_key(path);
+}
+
+Journal::Journal(std::filesystem::path file_path, const std::filesystem::path &input_path, bool resume)
+    : file_path_(std::move(file_path))
+{
+    const auto input_key = journal_key(input_path);
+
+    if (resume)
+    {
+        std::ifstream previous(file_path_);
+        std::string line;
+        size_t entries = 0;
+        while (std::getline(previous, line))
+        {
+            // The last line may have been cut by a crash, and a corrupted line must not stop the run
+            const auto json = nlohmann::json::parse(line, nullptr, false);
+            if (json.is_discarded() || !json.contains("kind") || !json.contains("path"))
+                continue;
+            if (!json["kind"].is_string() || !json["path"].is_string())
+                continue;
+
+            const auto kind = json["kind"].get<std::string>();
+            auto path       = json["path"].get<std::string>();
+
+            if (kind == k_kind_input && path != input_key)
+            {
+                PLOGW << "The journal is for another input path, starting from scratch";
+                mods_done_.clear();
+                archives_packed_.clear();
+                files_transformed_.clear();
+                entries = 0;
+                break;
+            }
+
+            if (kind == k_kind_mod_done)
+                mods_done_.emplace(std::move(path));
+            else if (kind == k_kind_archives_packed)
+                archives_packed_.emplace(std::move(path));
+            else if (kind == k_kind_file_transformed && json.contains("hash")
+                     && json["hash"].is_number_unsigned())
+                files_transformed_.insert_or_assign(std::move(path), json["hash"].get<uint64_t>());
+            else
+                continue;
+            ++entries;
+        }
+
+        if (entries > 0)
+            PLOGI << fmt::format("Resuming previous run: {} mods, {} files already done",
+                                 mods_done_.size(),
+                                 files_transformed_.size());
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(file_path_.parent_path(), ec);
+
+    has_previous_files_ = !files_transformed_.empty();
+
+    // A resumed journal is appended to, so a crash now cannot lose the previous entries
+    const bool resuming = !mods_done_.empty() || !archives_packed_.empty() || !files_transformed_.empty();
+
+    stream_.open(file_path_, resuming ? std::ios::app : std::ios::trunc);
+    writable_   = static_cast<bool>(stream_);
+    last_flush_ = std::chrono::steady_clock::now();
+    if (!writable_)
+    {
+        PLOGW << "Failed to open the journal " << file_path_.string() << ". The run will not be resumable";
+        return;
+    }
+
+    if (!resuming)
+    {
+        {
+            const auto lock = std::scoped_lock(mutex_);
+            append(k_kind_input, input_key, std::nullopt);
+        }
+        flush();
+    }
+}
+
+Journal::~Journal()
+{
+    flush();
+}
+
+auto Journal::append(std::string_view kind, const std::string &key, std::optional<uint64_t> hash) -> bool
+{
+    if (!writable_)
+        return false;
+
+    auto json = nlohmann::json{{"kind", kind}, {"path", key}};
+    if (hash)
+        json["hash"] = *hash;
+
+    pending_ += json.dump();
+    pending_ += '\n';
+
+    return pending_.size() >= k_flush_bytes
+           || std::chrono::steady_clock::now() - last_flush_ >= k_flush_interval;
+}
+
+void Journal::flush()
+{
+    const auto write_lock = std::scoped_lock(write_mutex_);
+
+    const auto pending = [this] {
+        const auto lock = std::scoped_lock(mutex_);
+        last_flush_     = std::chrono::steady_clock::now();
+        return std::exchange(pending_, {});
+    }();
+
+    if (pending.empty() || !stream_.is_open())
+        return;
+
+    stream_ << pending;
+    stream_.flush();
+}
+
+void Journal::record_mod_done(const std::filesystem::path &mod_path)
+{
+    auto key = journal_key(mod_path);
+    {
+        const auto lock = std::scoped_lock(mutex_);
+        append(k_kind_mod_done, key, std::nullopt);
+        mods_done_.emplace(std::move(key));
+    }
+    // Also writes the entries of the files of the mod, which come before
+    flush();
+}
+
+void Journal::record_archives_packed(const std::filesystem::path &directory_path)
+{
+    auto key = journal_key(directory_path);
+    {
+        const auto lock = std::scoped_lock(mutex_);
+        append(k_kind_archives_packed, key, std::nullopt);
+        archives_packed_.emplace(std::move(key));
+    }
+    flush();
+}
+
+void Journal::record_file_transformed(const std::filesystem::path &file_path,
+                                      FileSource source,
+                                      uint64_t output_hash)
+{
+    auto key       = file_journal_key(file_path, source);
+    bool flush_due = false;
+    {
+        const auto lock = std::scoped_lock(mutex_);
+        flush_due       = append(k_kind_file_transformed, key, output_hash);
+        files_transformed_.insert_or_assign(std::move(key), output_hash);
+    }
+
+    if (flush_due)
+        flush();
+}
+
+auto Journal::is_mod_done(const std::filesystem::path &mod_path) const -> bool
+{
+    const auto key  = journal_key(mod_path);
+    const auto lock = std::scoped_lock(mutex_);
+    return mods_done_.contains(key);
+}
+
+auto Journal::are_archives_packed(const std::filesystem::path &directory_path) const -> bool
+{
+    const auto key  = journal_key(directory_path);
+    const auto lock = std::scoped_lock(mutex_);
+    return archives_packed_.contains(key);
+}
+
+auto Journal::is_file_transformed(const std::filesystem::path &file_path,
+                                  FileSource source,
+                                  uint64_t content_hash) const -> bool
+{
+    const auto key  = file_journal_key(file_path, source);
+    const auto lock = std::scoped_lock(mutex_);
+
+    const auto it = files_transformed_.find(key);
+    return it != files_transformed_.end() && it->second == content_hash;
+}
+
+void Journal::finish()
+{
+    const auto write_lock = std::scoped_lock(write_mutex_);
+    {
+        const auto lock = std::scoped_lock(mutex_);
+        pending_.clear();
+    }
+    stream_.close();
+
+    std::error_code ec;
+    std::filesystem::remove(file_path_, ec);
+}
+} // namespace cao
@@ -0,0 +1,94 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace cao {
+/// @brief Where a file comes from. A loose file and an archived file can share a path
+enum class FileSource : std::uint8_t
+{
+    Loose,
+    Archive,
+};
+
+/// @brief Append-only record of the work done by a run, used to resume it after a crash or a stop.
+/// Each entry is a JSON line. Entries are buffered and written at most a second after they are recorded, or
+/// right away for the completion of a mod. A crash loses the last entries, whose work is then done again.
+/// All functions are thread safe.
+class Journal
+{
+public:
+    /// @brief Opens the journal at `file_path`.
+    /// @param resume Keep the entries of the previous run, if it was a run on the same input. Otherwise the
+    /// journal starts empty
+    Journal(std::filesystem::path file_path, const std::filesystem::path &input_path, bool resume);
+
+    Journal(const Journal &)                     = delete;
+    auto operator=(const Journal &) -> Journal & = delete;
+
+    Journal(Journal &&)                     = delete;
+    auto operator=(Journal &&) -> Journal & = delete;
+
+    /// @brief Writes the buffered entries
+    ~Journal();
+
+    void record_mod_done(const std::filesystem::path &mod_path);
+    void record_archives_packed(const std::filesystem::path &directory_path);
+    /// @param output_hash Hash of the content written for the file
+    void record_file_transformed(const std::filesystem::path &file_path,
+                                 FileSource source,
+                                 uint64_t output_hash);
+
+    [[nodiscard]] auto is_mod_done(const std::filesystem::path &mod_path) const -> bool;
+    [[nodiscard]] auto are_archives_packed(const std::filesystem::path &directory_path) const -> bool;
+    /// @brief Whether the file was transformed and still has the content that was written then
+    [[nodiscard]] auto is_file_transformed(const std::filesystem::path &file_path,
+                                           FileSource source,
+                                           uint64_t content_hash) const -> bool;
+
+    /// @brief Whether the previous run recorded transformed files. Hashing inputs to call
+    /// `is_file_transformed` is only worth it if so
+    [[nodiscard]] auto has_previous_files() const noexcept -> bool { return has_previous_files_; }
+
+    /// @brief Writes the buffered entries to disk
+    void flush();
+
+    /// @brief Deletes the journal. Called once a run is complete, so the next run does not resume it
+    void finish();
+
+    static constexpr auto k_file_name = "journal.jsonl";
+
+private:
+    /// @brief Buffers an entry. Must be called with `mutex_` held
+    /// @return Whether the buffer is due to be written
+    auto append(std::string_view kind, const std::string &key, std::optional<uint64_t> hash)
+        -> bool;
+
+    std::filesystem::path file_path_;
+    bool writable_           = false;
+    bool has_previous_files_ = false;
+
+    /// Held while writing, so entries reach the file in order without blocking the recording threads
+    std::mutex write_mutex_;
+    std::ofstream stream_;
+
+    mutable std::mutex mutex_;
+    std::string pending_;
+    std::chrono::steady_clock::time_point last_flush_;
+
+    std::unordered_set<std::string> mods_done_;
+    std::unordered_set<std::string> archives_packed_;
+    std::unordered_map<std::string, uint64_t> files_transformed_;
+};
+} // namespace cao
@@ -0,0 +1,272 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "log_appender.hpp"
+
+#include "log_buffer.hpp"
+
+#include <fmt/format.h>
+#include <plog/Record.h>
+#include <plog/Util.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <string_view>
+#include <tuple>
+
+namespace cao {
+auto LogLine::from(const plog::Record &record) -> LogLine
+{
+    return LogLine{
+        .time      = record.getTime().time,
+        .millitm   = record.getTime().millitm,
+        .severity  = record.getSeverity(),
+        .thread_id = record.getTid(),
+        .line      = record.getLine(),
+        .function  = record.getFunc(),
+#ifdef _WIN32
+        .message = plog::util::toNarrow(record.getMessage(), plog::codePage::kUTF8),
+#else
+        .message = record.getMessage(),
+#endif
+    };
+}
+
+void format_log_line(const LogLine &line, std::string &out)
+{
+    tm t{};
+    plog::util::localtime_s(&t, &line.time);
+
+    fmt::format_to(std::back_inserter(out),
+                   "{:04}-{:02}-{:02} {:02}:{:02}:{:02}.{:03} {:<5} [{}] [{}@{}] {}|\n",
+                   t.tm_year + 1900,
+                   t.tm_mon + 1,
+                   t.tm_mday,
+                   t.tm_hour,
+                   t.tm_min,
+                   t.tm_sec,
+                   line.millitm,
+                   plog::severityToString(line.severity),
+                   line.thread_id,
+                   line.function,
+                   line.line,
+                   line.message);
+}
+
+AsyncFileAppender::QueueHandle::~QueueHandle()
+{
+    queue->abandoned.store(true, std::memory_order_release);
+}
+
+AsyncFileAppender::AsyncFileAppender(std::filesystem::path file_path,
+                                     size_t max_file_size,
+                                     size_t max_files,
+                                     LogBuffer &buffer)
+    : file_path_(std::move(file_path))
+    , max_file_size_(std::max(max_file_size, size_t{1}))
+    , max_files_(std::max(max_files, size_t{1}))
+    , buffer_(buffer)
+{
+    roll_files(); // Every run starts a new file
+
+    writer_ = std::jthread([this](std::stop_token stop_token) { run_writer(std::move(stop_token)); });
+}
+
+AsyncFileAppender::~AsyncFileAppender()
+{
+    writer_.request_stop();
+    writer_.join();
+}
+
+void AsyncFileAppender::write(const plog::Record &record)
+{
+    auto &queue = thread_queue();
+    auto line   = LogLine::from(record);
+
+    // Records logged while the program exits, no one would drain the queue
+    if (!writer_running_.load(std::memory_order_acquire))
+    {
+        write_synchronously(std::move(line));
+        return;
+    }
+
+    const auto tail = queue.tail.load(std::memory_order_relaxed);
+
+    // The writer is late: wait for it instead of dropping records
+    while (tail - queue.head.load(std::memory_order_acquire) >= Queue::k_capacity)
+    {
+        if (!writer_running_.load(std::memory_order_acquire))
+        {
+            write_synchronously(std::move(line));
+            return;
+        }
+
+        urgent_.store(true, std::memory_order_relaxed);
+        wake_.notify_one();
+        std::this_thread::yield();
+    }
+
+    queue.lines[tail % Queue::k_capacity] = std::move(line);
+    queue.tail.store(tail + 1, std::memory_order_release);
+
+    // Errors are written right away, they are the most likely to precede a crash
+    if (record.getSeverity() <= plog::error)
+    {
+        urgent_.store(true, std::memory_order_relaxed);
+        wake_.notify_one();
+    }
+}
+
+auto AsyncFileAppender::thread_queue() -> Queue &
+{
+    // There is a single appender, so a thread needs a single queue
+    thread_local const auto handle = [this] {
+        auto queue      = std::make_shared<Queue>();
+        const auto lock = std::scoped_lock(queues_mutex_);
+        queues_.emplace_back(queue);
+        return QueueHandle{std::move(queue)};
+    }();
+
+    return *handle.queue;
+}
+
+void AsyncFileAppender::run_writer(std::stop_token stop_token)
+{
+    constexpr auto k_interval = std::chrono::milliseconds(50);
+
+    while (!stop_token.stop_requested())
+    {
+        {
+            auto lock = std::unique_lock(wake_mutex_);
+            wake_.wait_for(lock, stop_token, k_interval, [this] {
+                return urgent_.load(std::memory_order_relaxed);
+            });
+        }
+        urgent_.store(false, std::memory_order_relaxed);
+
+        drain();
+    }
+
+    // Threads may still be logging while the program exits
+    while (drain())
+        ;
+
+    // The file now belongs to the logging threads
+    writer_running_.store(false, std::memory_order_release);
+}
+
+auto AsyncFileAppender::drain() -> bool
+{
+    auto queues = [this] {
+        const auto lock = std::scoped_lock(queues_mutex_);
+        return queues_;
+    }();
+
+    auto lines = std::vector<LogLine>{};
+    for (auto &queue : queues)
+    {
+        // Read before draining, so the records pushed just before the thread exited are not lost
+        const bool abandoned = queue->abandoned.load(std::memory_order_acquire);
+
+        const auto head = queue->head.load(std::memory_order_relaxed);
+        const auto tail = queue->tail.load(std::memory_order_acquire);
+        for (auto i = head; i < tail; ++i)
+            lines.emplace_back(std::move(queue->lines[i % Queue::k_capacity]));
+        queue->head.store(tail, std::memory_order_release);
+
+        if (abandoned)
+        {
+            const auto lock = std::scoped_lock(queues_mutex_);
+            std::erase(queues_, queue);
+        }
+    }
+
+    if (lines.empty())
+        return false;
+
+    write_batch(lines);
+    return true;
+}
+
+void AsyncFileAppender::write_batch(std::vector<LogLine> &lines)
+{
+    // Each queue is ordered, but the queues are interleaved
+    std::ranges::stable_sort(lines, [](const LogLine &a, const LogLine &b) {
+        return std::tie(a.time, a.millitm) < std::tie(b.time, b.millitm);
+    });
+
+    auto entries = std::vector<LogEntry>{};
+    entries.reserve(lines.size());
+
+    for (const auto &line : lines)
+    {
+        const auto start = pending_.size();
+        format_log_line(line, pending_);
+
+        // Without the `|` and line end
+        const auto text = std::string_view(pending_).substr(start, pending_.size() - start - 2);
+        entries.emplace_back(QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size())),
+                             line.severity);
+
+        if (file_size_ + pending_.size() >= max_file_size_)
+        {
+            flush_pending();
+            roll_files();
+        }
+    }
+
+    flush_pending();
+    buffer_.push(std::move(entries));
+}
+
+void AsyncFileAppender::write_synchronously(LogLine line)
+{
+    const auto lock = std::scoped_lock(synchronous_mutex_);
+
+    auto lines = std::vector<LogLine>{};
+    lines.emplace_back(std::move(line));
+    write_batch(lines);
+}
+
+void AsyncFileAppender::flush_pending()
+{
+    if (pending_.empty())
+        return;
+
+    if (!file_.is_open())
+    {
+        file_.open(file_path_, std::ios::binary | std::ios::app);
+        file_size_ = 0;
+    }
+
+    file_.write(pending_.data(), static_cast<std::streamsize>(pending_.size()));
+    file_.flush();
+    file_size_ += pending_.size();
+    pending_.clear();
+}
+
+void AsyncFileAppender::roll_files()
+{
+    file_.close();
+    file_size_ = 0;
+
+    // cao.log -> cao.1.log -> cao.2.log ..., the same names as plog's rolling appender
+    const auto stem      = file_path_.stem().string();
+    const auto extension = file_path_.extension().string();
+    const auto rolled    = [&](size_t index) {
+        return file_path_.parent_path() / fmt::format("{}.{}{}", stem, index, extension);
+    };
+
+    std::error_code ec; // A missing file is not an error
+    std::filesystem::remove(rolled(max_files_ - 1), ec);
+    for (auto i = max_files_ - 1; i > 1; --i)
+        std::filesystem::rename(rolled(i - 1), rolled(i), ec);
+    if (max_files_ > 1)
+        std::filesystem::rename(file_path_, rolled(1), ec);
+    else
+        std::filesystem::remove(file_path_, ec);
+}
+} // namespace cao
@@ -0,0 +1,120 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <plog/Appenders/IAppender.h>
+#include <plog/Severity.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cao {
+class LogBuffer;
+
+/// @brief A log record copied out of plog, so it can be formatted on another thread
+struct LogLine
+{
+    std::time_t time        = 0;
+    unsigned short millitm  = 0;
+    plog::Severity severity = plog::none;
+    unsigned int thread_id  = 0;
+    size_t line             = 0;
+    std::string function;
+    /// UTF-8
+    std::string message;
+
+    [[nodiscard]] static auto from(const plog::Record &record) -> LogLine;
+};
+
+/// @brief Appends the line as it is written to the log file, `|` and line end included
+void format_log_line(const LogLine &line, std::string &out);
+
+/// @brief Writes log records to a rolling file from a dedicated thread.
+/// Each logging thread pushes its records to its own queue, without locking. The writer thread drains all
+/// queues at a short interval, and writes them in one batch. Records are also forwarded to `buffer`.
+class AsyncFileAppender final : public plog::IAppender
+{
+public:
+    AsyncFileAppender(std::filesystem::path file_path,
+                      size_t max_file_size,
+                      size_t max_files,
+                      LogBuffer &buffer);
+
+    AsyncFileAppender(const AsyncFileAppender &)                     = delete;
+    auto operator=(const AsyncFileAppender &) -> AsyncFileAppender & = delete;
+
+    AsyncFileAppender(AsyncFileAppender &&)                     = delete;
+    auto operator=(AsyncFileAppender &&) -> AsyncFileAppender & = delete;
+
+    /// @brief Writes the records still queued, then stops the writer thread
+    ~AsyncFileAppender() override;
+
+    void write(const plog::Record &record) override;
+
+private:
+    /// Single producer, single consumer ring of records
+    struct Queue
+    {
+        static constexpr size_t k_capacity = 1024;
+
+        std::array<LogLine, k_capacity> lines;
+        alignas(64) std::atomic_size_t head{0}; // Only written by the writer thread
+        alignas(64) std::atomic_size_t tail{0}; // Only written by the owning thread
+        /// Set when the owning thread exits, the queue is removed once drained
+        std::atomic_bool abandoned{false};
+    };
+
+    struct QueueHandle
+    {
+        std::shared_ptr<Queue> queue;
+
+        ~QueueHandle();
+    };
+
+    [[nodiscard]] auto thread_queue() -> Queue &;
+    void run_writer(std::stop_token stop_token);
+    /// @return Whether records were written
+    auto drain() -> bool;
+    void write_batch(std::vector<LogLine> &lines);
+    /// @brief Writes a record from the logging thread, once the writer thread is gone
+    void write_synchronously(LogLine line);
+    void flush_pending();
+    /// @brief Renames the existing files, so the next records start a new one
+    void roll_files();
+
+    std::filesystem::path file_path_;
+    size_t max_file_size_;
+    size_t max_files_;
+    LogBuffer &buffer_;
+
+    std::mutex queues_mutex_;
+    std::vector<std::shared_ptr<Queue>> queues_;
+
+    /// Only used by the writer thread
+    std::ofstream file_;
+    size_t file_size_ = 0;
+    std::string pending_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable_any wake_;
+    std::atomic_bool urgent_{false};
+
+    /// Cleared once the writer thread has written its last records
+    std::atomic_bool writer_running_{true};
+    /// Logging threads writing synchronously share the file
+    std::mutex synchronous_mutex_;
+
+    std::jthread writer_;
+};
+} // namespace cao
@@ -0,0 +1,46 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "log_buffer.hpp"
+
+#include <algorithm>
+
+namespace cao {
+LogBuffer::LogBuffer(size_t capacity)
+    : entries_(std::max(capacity, size_t{1}))
+{
+}
+
+void LogBuffer::push(std::vector<LogEntry> entries)
+{
+    const auto lock = std::scoped_lock(mutex_);
+    for (auto &entry : entries)
+    {
+        entries_[next_sequence_ % entries_.size()] = std::move(entry);
+        ++next_sequence_;
+    }
+}
+
+auto LogBuffer::read_since(uint64_t &cursor) const -> std::vector<LogEntry>
+{
+    const auto lock = std::scoped_lock(mutex_);
+
+    const auto oldest = next_sequence_ > entries_.size() ? next_sequence_ - entries_.size() : 0;
+    cursor            = std::clamp(cursor, oldest, next_sequence_);
+
+    auto result = std::vector<LogEntry>{};
+    result.reserve(next_sequence_ - cursor);
+    for (; cursor < next_sequence_; ++cursor)
+        result.push_back(entries_[cursor % entries_.size()]);
+
+    return result;
+}
+
+auto LogBuffer::end_cursor() const -> uint64_t
+{
+    const auto lock = std::scoped_lock(mutex_);
+    return next_sequence_;
+}
+} // namespace cao
@@ -0,0 +1,44 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <plog/Severity.h>
+
+#include <QString>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace cao {
+struct LogEntry
+{
+    QString text;
+    plog::Severity severity = plog::none;
+};
+
+/// @brief Keeps the most recent log records in memory, so they can be displayed without reading the log file.
+/// Once full, new records overwrite the oldest ones.
+class LogBuffer
+{
+public:
+    explicit LogBuffer(size_t capacity);
+
+    void push(std::vector<LogEntry> entries);
+
+    /// @brief Returns the records written since `cursor`, and moves `cursor` past them.
+    /// Records that were overwritten before being read are skipped.
+    [[nodiscard]] auto read_since(uint64_t &cursor) const -> std::vector<LogEntry>;
+
+    /// @brief A cursor past all the records written so far
+    [[nodiscard]] auto end_cursor() const -> uint64_t;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<LogEntry> entries_;
+    /// Sequence number of the next record, the ring index is `next_sequence_ % capacity`
+    uint64_t next_sequence_ = 0;
+};
+} // namespace cao
@@ -5,9 +5,12 @@
 
 #include "logger.hpp"
 
+#include "log_appender.hpp"
+#include "log_buffer.hpp"
+#include "settings/settings.hpp"
+
 #include <fmt/chrono.h>
 #include <plog/Appenders/ColorConsoleAppender.h>
-#include <plog/Appenders/RollingFileAppender.h>
 #include <plog/Formatters/TxtFormatter.h>
 #include <plog/Init.h>
 #include <plog/Log.h>
@@ -17,28 +20,34 @@
 
 namespace cao {
 
-class CustomFormatter
-{
-public:
-    [[maybe_unused]] [[nodiscard]] static auto header() -> plog::util::nstring;
-    [[maybe_unused]] [[nodiscard]] static auto format(const plog::Record &record) -> plog::util::nstring;
-};
+/// Instance of the logger only writing to the console
+constexpr int k_console_logger = 1;
 
-[[nodiscard]] auto get_appender(const std::filesystem::path &log_file_path) noexcept -> plog::IAppender *
+[[nodiscard]] auto get_appender(const std::filesystem::path &log_file_path,
+                                const LogSettings &settings) noexcept -> plog::IAppender *
 {
-    constexpr size_t max_file_size = 1'000'000; // 1MB
-    constexpr size_t keep_files    = 20;
-    // plog requires a static appender
-    static auto appender = plog::RollingFileAppender<CustomFormatter>(log_file_path.string().c_str(),
-                                                                      max_file_size,
-                                                                      keep_files);
+    constexpr size_t k_bytes_per_mb = 1024 * 1024;
 
-    appender.rollLogFiles(); // Roll log files on every start
+    // plog requires a static appender. Log files are rolled on every start
+    static auto appender = AsyncFileAppender(log_file_path,
+                                             settings.file_size_mb * k_bytes_per_mb,
+                                             settings.kept_files,
+                                             log_buffer());
 
     return &appender;
 }
 
-[[nodiscard]] auto init_logging(const std::filesystem::path &log_directory) noexcept -> bool
+auto log_buffer() noexcept -> LogBuffer &
+{
+    // Enough for a few seconds of verbose logging, the GUI reads it several times per second
+    constexpr size_t k_capacity = 10'000;
+
+    static auto buffer = LogBuffer(k_capacity);
+    return buffer;
+}
+
+[[nodiscard]] auto init_logging(const std::filesystem::path &log_directory,
+                                const LogSettings &settings) noexcept -> bool
 {
     // Cancelling if logger is already ready
     if (plog::get() != nullptr)
@@ -57,9 +66,13 @@ public:
             return false;
     }
 
-    static plog::ColorConsoleAppender<CustomFormatter> console_appender;
+    // stdout is reserved for machine-readable output in CLI mode
+    static plog::ColorConsoleAppender<CustomFormatter> console_appender(plog::streamStdErr);
+
+    // Writing to the console is synchronous, so verbose records are filtered out before reaching it
+    auto &console_logger = plog::init<k_console_logger>(plog::Severity::info, &console_appender);
 
-    plog::init(plog::Severity::verbose, get_appender(log_file_path)).addAppender(&console_appender);
+    plog::init(plog::Severity::verbose, get_appender(log_file_path, settings)).addAppender(&console_logger);
 
     PLOGV << fmt::format("Logging initialized at time: {}", std::chrono::system_clock::now());
     return true;
@@ -72,26 +85,12 @@ public:
 
 [[maybe_unused]] auto CustomFormatter::format(const plog::Record &record) -> plog::util::nstring
 {
-    tm t{};
-    plog::util::localtime_s(&t, &record.getTime().time);
-
-    plog::util::nostringstream ss;
-    ss
-        // Time
-        << t.tm_year + 1900 << "-" << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_mon + 1
-        << PLOG_NSTR("-") << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_mday << PLOG_NSTR(" ")
-        << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_hour << PLOG_NSTR(":")
-        << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_min << PLOG_NSTR(":")
-        << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_sec << PLOG_NSTR(".")
-        << std::setfill(PLOG_NSTR('0')) << std::setw(3) << record.getTime().millitm << PLOG_NSTR(" ")
-        << std::setfill(PLOG_NSTR(' ')) << std::setw(5)
-        << std::left
-        // Actual message
-        << severityToString(record.getSeverity()) << PLOG_NSTR(" ") << PLOG_NSTR("[") << record.getTid()
-        << PLOG_NSTR("] ") << PLOG_NSTR("[") << record.getFunc() << PLOG_NSTR("@") << record.getLine()
-        << PLOG_NSTR("] ") << record.getMessage() << PLOG_NSTR('|') // Makes life easier for parsers
-        << PLOG_NSTR("\n");
-
-    return ss.str();
+    auto line = std::string{};
+    format_log_line(LogLine::from(record), line);
+#ifdef _WIN32
+    return plog::util::toWide(line.c_str(), plog::codePage::kUTF8);
+#else
+    return line;
+#endif
 }
 } // namespace cao
@@ -5,11 +5,28 @@
 
 #pragma once
 
+#include <plog/Record.h>
+#include <plog/Util.h>
+
 #include <filesystem>
 
 namespace cao {
+class LogBuffer;
+struct LogSettings;
 
 constexpr auto k_log_file_name = "cao.log";
 
-[[nodiscard]] auto init_logging(const std::filesystem::path &log_directory) noexcept -> bool;
+/// @brief Formats records for the console, the same way as in the log file
+class CustomFormatter
+{
+public:
+    [[maybe_unused]] [[nodiscard]] static auto header() -> plog::util::nstring;
+    [[maybe_unused]] [[nodiscard]] static auto format(const plog::Record &record) -> plog::util::nstring;
+};
+
+[[nodiscard]] auto init_logging(const std::filesystem::path &log_directory,
+                                const LogSettings &settings) noexcept -> bool;
+
+/// @brief The most recent log records, for display in the GUI
+[[nodiscard]] auto log_buffer() noexcept -> LogBuffer &;
 } // namespace cao
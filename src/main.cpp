@@ -3,10 +3,10 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
+#include "cli.hpp"
 #include "gui/MainWindow.hpp"
 #include "gui/utils/utils.hpp"
 #include "logger.hpp"
-#include "manager.hpp"
 #include "settings/settings.hpp"
 #include "version.hpp"
 
@@ -60,7 +60,7 @@ auto main(int argc, char *argv[]) -> int
 
     QCommandLineParser parser;
     parser.addPositionalArgument("profile", "The profile to use");
-    parser.addOption({"cli", "Do not run the GUI"});
+    cao::add_cli_options(parser);
     parser.process(*app);
 
     const bool cli = parser.isSet("cli");
@@ -75,21 +75,15 @@ auto main(int argc, char *argv[]) -> int
 
     try
     {
-        if (!cao::init_logging(cao::Settings::state_directory()))
-            throw std::runtime_error("Failed to initialize logging.");
-
+        // Loaded first, as they configure the log files
         auto settings = cao::load_settings();
 
+        if (!cao::init_logging(cao::Settings::state_directory(), settings.log))
+            throw std::runtime_error("Failed to initialize logging.");
+
         if (cli)
         {
-            const auto profile_name = parser.positionalArguments().value(0);
-
-            auto profile = settings.get_profile(cao::to_u8string(profile_name));
-            if (!profile)
-                throw std::runtime_error("Profile not found");
-
-            cao::Manager manager;
-            manager.run_optimization(settings, std::stop_token{}); // TODO: handle signals
+            return cao::run_cli(parser, std::move(settings));
         }
         else
         {
@@ -101,7 +95,7 @@ auto main(int argc, char *argv[]) -> int
     catch (const std::exception &e)
     {
         display_error(cli, e.what());
-        return 1;
+        return cao::k_exit_error;
     }
 
     return 0;
@@ -5,6 +5,8 @@
 
 #include "main_process.hpp"
 
+#include "texture_encoder.hpp"
+
 #include <btu/common/games.hpp>
 #include <btu/common/metaprogramming.hpp>
 #include <btu/common/string.hpp>
@@ -125,132 +127,242 @@ void log_file_no_work_required(const std::filesystem::path &path) noexcept
     PLOGV << fmt::format("No work required for file: {}", path.string());
 }
 
-[[nodiscard]] auto process_mesh(btu::modmanager::ModFile &&file,
+/// @brief Frees a buffer that is no longer needed, instead of keeping it until the end of the scope
+void release(std::vector<std::byte> &buffer) noexcept
+{
+    std::vector<std::byte>().swap(buffer);
+}
+
+[[nodiscard]] auto process_mesh(const std::filesystem::path &relative_path,
+                                std::vector<std::byte> content,
                                 const btu::nif::Settings &settings,
-                                const OptimizeType type) noexcept
+                                const OptimizeType type,
+                                RunStatistics &stats) noexcept
     -> tl::expected<std::vector<std::byte>, btu::common::Error>
 {
     if (type == OptimizeType::None)
         return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
 
-    return file.content
-        ->and_then(
-            [&file](std::vector<std::byte> content) { return btu::nif::load(file.relative_path, content); })
+    auto loaded = [&] {
+        auto timer = stats.time(Stage::MeshLoad, content.size());
+        return btu::nif::load(relative_path, content);
+    }();
+
+    // The mesh owns its data once loaded, the file content is not needed during the optimization
+    release(content);
+
+    return std::move(loaded)
         .and_then([&](auto &&nif) -> tl::expected<btu::nif::Mesh, btu::common::Error> {
-            auto steps = btu::nif::compute_optimization_steps(nif, settings);
+            auto steps = [&] {
+                auto timer = stats.time(Stage::MeshComputeSteps);
+                return btu::nif::compute_optimization_steps(nif, settings);
+            }();
 
             if (steps_are_empty(steps))
             {
-                log_file_no_work_required(file.relative_path);
+                log_file_no_work_required(relative_path);
                 return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
             }
 
             if (type == OptimizeType::Forced)
                 steps.format = std::optional(settings.target_game); // force conversion
 
-            log_file_processing(file.relative_path, human_readable_step_string(steps));
+            log_file_processing(relative_path, human_readable_step_string(steps));
 
             if (type == OptimizeType::DryRun)
                 return nif;
 
+            auto timer = stats.time(Stage::MeshOptimize);
             return btu::nif::optimize(BTU_FWD(nif), steps);
         })
-        .and_then([type](auto &&nif) -> tl::expected<std::vector<std::byte>, btu::common::Error> {
+        .and_then([&](auto &&nif) -> tl::expected<std::vector<std::byte>, btu::common::Error> {
             if (type == OptimizeType::DryRun)
                 return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
 
-            return btu::nif::save(BTU_FWD(nif));
+            auto timer = stats.time(Stage::MeshSave);
+            auto saved = btu::nif::save(BTU_FWD(nif));
+            if (saved)
+                timer.set_bytes_out(saved->size());
+            return saved;
         });
 }
 
-[[nodiscard]] auto process_texture(btu::modmanager::ModFile &&file,
+[[nodiscard]] auto process_texture(const std::filesystem::path &relative_path,
+                                   std::vector<std::byte> content,
                                    const btu::tex::Settings &settings,
-                                   const OptimizeType type) noexcept
+                                   const CompressionTier tier,
+                                   const OptimizeType type,
+                                   RunResources &resources) noexcept
     -> tl::expected<std::vector<std::byte>, btu::common::Error>
 {
-    static auto compression_device = btu::tex::CompressionDevice();
-
     if (type == OptimizeType::None)
         return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
 
-    return file.content
-        ->and_then([&file](auto &&content) { return btu::tex::load(file.relative_path, content); })
+    auto &stats = resources.statistics;
+    auto loaded = [&] {
+        auto timer = stats.time(Stage::TextureLoad, content.size());
+        return btu::tex::load(relative_path, content);
+    }();
+
+    // The decoded image is a copy, the file content does not have to live through the compression
+    release(content);
+
+    return std::move(loaded)
         .and_then([&](auto &&tex) -> tl::expected<btu::tex::Texture, btu::common::Error> {
-            auto steps = btu::tex::compute_optimization_steps(tex, settings);
+            auto steps = [&] {
+                auto timer = stats.time(Stage::TextureComputeSteps);
+                return btu::tex::compute_optimization_steps(tex, settings);
+            }();
 
             if (steps_are_empty(steps))
             {
-                log_file_no_work_required(file.relative_path);
+                log_file_no_work_required(relative_path);
                 return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
             }
 
             if (type == OptimizeType::Forced)
                 steps.convert = true;
 
-            log_file_processing(file.relative_path, human_readable_step_string(steps));
+            log_file_processing(relative_path, human_readable_step_string(steps));
 
             if (type == OptimizeType::DryRun)
                 return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
 
-            return btu::tex::optimize(BTU_FWD(tex), steps, compression_device);
+            auto timer = stats.time(Stage::TextureOptimize);
+
+            const auto target_format = steps.convert ? steps.best_format : tex.get().GetMetadata().format;
+            const bool use_cpu       = resources.texture_encoder == TextureEncoder::Cpu
+                                       && can_encode_on_cpu(tex.get().GetMetadata(), target_format);
+            if (!use_cpu)
+            {
+                // Each worker gets its own device, so textures are not compressed one at a time
+                return resources.compression_devices.acquire().and_then([&](auto &&device) {
+                    return btu::tex::optimize(BTU_FWD(tex), steps, *device);
+                });
+            }
+
+            // The device still decodes, resizes and generates mipmaps, only the compression is moved
+            steps.convert     = true;
+            steps.best_format = cpu_encoder_input_format(target_format);
+
+            auto uncompressed = resources.compression_devices.acquire().and_then([&](auto &&device) {
+                return btu::tex::optimize(BTU_FWD(tex), steps, *device);
+            }); // The device is released here, before the long part
+
+            return std::move(uncompressed).and_then([&](auto &&rgba) {
+                return encode_on_cpu(BTU_FWD(rgba), target_format, tier, resources.executor);
+            });
         })
-        .and_then([type](auto &&tex) -> tl::expected<std::vector<std::byte>, btu::common::Error> {
+        .and_then([&](auto &&tex) -> tl::expected<std::vector<std::byte>, btu::common::Error> {
             if (type == OptimizeType::DryRun)
                 return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
 
-            return btu::tex::save(BTU_FWD(tex));
+            auto timer = stats.time(Stage::TextureSave);
+            auto saved = btu::tex::save(BTU_FWD(tex));
+            if (saved)
+                timer.set_bytes_out(saved->size());
+            return saved;
         });
 }
 
-[[nodiscard]] auto process_animation(btu::modmanager::ModFile &&file,
+[[nodiscard]] auto process_animation(const std::filesystem::path &relative_path,
+                                     std::vector<std::byte> content,
                                      btu::Game hkx_target,
-                                     OptimizeType type) noexcept
+                                     OptimizeType type,
+                                     RunResources &resources) noexcept
     -> tl::expected<std::vector<std::byte>, btu::common::Error>
 {
     if (type == OptimizeType::None)
         return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
 
-    auto exe = btu::hkx::AnimExe::make("data"); // TODO: make this configurable
-    if (!exe)
-        return tl::make_unexpected(exe.error());
-
     // TODO: better dry run?
     if (type == OptimizeType::DryRun)
     {
-        PLOGI << std::format("{} might be optimized", file.relative_path.string());
+        PLOGI << std::format("{} might be optimized", relative_path.string());
         return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
     }
 
-    return file.content->and_then(
-        [&](std::vector<std::byte> content) { return exe->convert(hkx_target, content); });
+    // Setting up the converter is expensive, it is reused across files
+    auto exe = resources.anim_exes.acquire();
+    if (!exe)
+        return tl::make_unexpected(exe.error());
+
+    auto timer     = resources.statistics.time(Stage::AnimationConvert, content.size());
+    auto converted = (*exe)->convert(hkx_target, content);
+    if (converted)
+        timer.set_bytes_out(converted->size());
+    return converted;
 }
 
-auto process_file(btu::modmanager::ModFile &&file, const Settings &settings) noexcept
+auto optimize_type(FileType type, const PerFileSettings &file_sets, bool dry_run) noexcept -> OptimizeType
+{
+    const auto opt_type = [&] {
+        switch (type)
+        {
+            case FileType::Mesh: return file_sets.nif_optimize;
+            case FileType::Texture: return file_sets.tex_optimize;
+            case FileType::Animation: return file_sets.hkx_optimize;
+        }
+        return OptimizeType::None;
+    }();
+
+    const auto should_optimize = opt_type != OptimizeType::None;
+    return (dry_run && should_optimize) ? OptimizeType::DryRun : opt_type;
+}
+
+auto process_file(const std::filesystem::path &relative_path,
+                  std::vector<std::byte> content,
+                  const PerFileSettings &file_sets,
+                  bool dry_run,
+                  RunResources &resources) noexcept
     -> tl::expected<std::vector<std::byte>, btu::common::Error>
 {
-    const auto type       = guess_file_type(file.relative_path);
-    const auto &file_sets = settings.current_profile().get_per_file_settings(file.relative_path);
+    const auto type = guess_file_type(relative_path);
 
     if (!type)
         return tl::make_unexpected(btu::common::Error(k_error_no_work_required)); // TODO: better error
 
-    const auto get_optimize_type = [settings](OptimizeType opt_type) {
-        auto dry_run         = settings.current_profile().dry_run;
-        auto should_optimize = opt_type != OptimizeType::None;
-        return (dry_run && should_optimize) ? OptimizeType::DryRun : opt_type;
-    };
+    const auto opt_type = optimize_type(*type, file_sets, dry_run);
 
     switch (type.value())
     {
         case FileType::Mesh:
-            return process_mesh(std::move(file), file_sets.nif, get_optimize_type(file_sets.nif_optimize));
+            return process_mesh(relative_path,
+                                std::move(content),
+                                file_sets.nif,
+                                opt_type,
+                                resources.statistics);
         case FileType::Texture:
-            return process_texture(std::move(file), file_sets.tex, get_optimize_type(file_sets.tex_optimize));
+            return process_texture(relative_path,
+                                   std::move(content),
+                                   file_sets.tex,
+                                   file_sets.tex_compression_tier,
+                                   opt_type,
+                                   resources);
         case FileType::Animation:
-            return process_animation(std::move(file),
+            return process_animation(relative_path,
+                                     std::move(content),
                                      file_sets.hkx_target,
-                                     get_optimize_type(file_sets.hkx_optimize));
+                                     opt_type,
+                                     resources);
     }
     return tl::make_unexpected(btu::common::Error(k_unreachable));
 }
+
+auto process_file(btu::modmanager::ModFile &&file,
+                  const PerFileSettings &file_sets,
+                  bool dry_run,
+                  RunResources &resources) noexcept
+    -> tl::expected<std::vector<std::byte>, btu::common::Error>
+{
+    // Files that will not be processed are not read at all
+    const auto type = guess_file_type(file.relative_path);
+    if (!type || optimize_type(*type, file_sets, dry_run) == OptimizeType::None)
+        return tl::make_unexpected(btu::common::Error(k_error_no_work_required));
+
+    // The file is ours, its content is moved instead of copied
+    return file.content->and_then([&](std::vector<std::byte> &content) {
+        return process_file(file.relative_path, std::move(content), file_sets, dry_run, resources);
+    });
+}
 } // namespace cao
@@ -4,6 +4,7 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 #pragma once
 
+#include "run_resources.hpp"
 #include "settings/settings.hpp"
 
 #include <btu/modmanager/mod_folder.hpp>
@@ -18,9 +19,26 @@ enum class FileType : std::uint8_t
 
 [[nodiscard]] auto guess_file_type(const std::filesystem::path &path) noexcept -> std::optional<FileType>;
 
+/// @brief How a file of `type` is going to be processed. None means it is not even read
+[[nodiscard]] auto optimize_type(FileType type, const PerFileSettings &file_sets, bool dry_run) noexcept
+    -> OptimizeType;
+
 const static auto k_error_no_work_required = std::error_code(0, std::generic_category());
 const static auto k_unreachable            = std::error_code(1, std::generic_category());
 
-[[nodiscard]] auto process_file(btu::modmanager::ModFile &&file, const Settings &settings) noexcept
+/// @brief Processes a file with settings that were already looked up.
+/// `content` is released as soon as it is decoded, so pass a copy only if it is needed afterwards.
+[[nodiscard]] auto process_file(const std::filesystem::path &relative_path,
+                                std::vector<std::byte> content,
+                                const PerFileSettings &file_sets,
+                                bool dry_run,
+                                RunResources &resources) noexcept
+    -> tl::expected<std::vector<std::byte>, btu::common::Error>;
+
+/// @brief Same as above, but only reads the file if it may be processed
+[[nodiscard]] auto process_file(btu::modmanager::ModFile &&file,
+                                const PerFileSettings &file_sets,
+                                bool dry_run,
+                                RunResources &resources) noexcept
     -> tl::expected<std::vector<std::byte>, btu::common::Error>;
 } // namespace cao
@@ -6,21 +6,32 @@
 #include "manager.hpp"
 
 #include "bsa_process.hpp"
+#include "conflict_index.hpp"
+#include "dedupe_store.hpp"
+#include "file_cache.hpp"
+#include "hash.hpp"
+#include "journal.hpp"
 #include "main_process.hpp"
+#include "mod_selection.hpp"
+#include "parallel.hpp"
+#include "plugin_index.hpp"
+#include "settings/per_file_settings_matcher.hpp"
 #include "settings/settings.hpp"
+#include "storage.hpp"
 
 #include <btu/bsa/pack.hpp>
 #include <btu/bsa/plugin.hpp>
 #include <btu/bsa/settings.hpp>
 #include <btu/bsa/unpack.hpp>
 #include <btu/common/string.hpp>
-#include <btu/esp/functions.hpp>
 #include <btu/modmanager/mod_manager.hpp>
 #include <fmt/chrono.h>
 #include <plog/Log.h>
 
+#include <atomic>
 #include <filesystem>
-#include <mutex>
+#include <future>
+#include <thread>
 #include <utility>
 namespace cao {
 
@@ -48,78 +59,20 @@ void rename_bad_file(const std::filesystem::path &file_path)
     }
 }
 
-struct PluginInfo
-{
-    std::vector<std::u8string> headparts;
-    std::vector<std::u8string> landscape_textures;
-};
-
-[[nodiscard]] auto get_plugin_info(btu::modmanager::ModFolder &mod) -> PluginInfo
+[[nodiscard]] auto get_bsa_settings(const Settings &sets) noexcept -> btu::bsa::Settings
 {
-    class PluginInfoVisitor final : public btu::modmanager::ModFolderIterator
-    {
-    public:
-        explicit PluginInfoVisitor(btu::Path mod_root)
-            : mod_root_(std::move(mod_root))
-        {
-        }
-
-        [[nodiscard]] auto archive_too_large(const btu::Path & /*archive_path*/,
-                                             ArchiveTooLargeState /*state*/) noexcept
-            -> ArchiveTooLargeAction override
-        {
-            return ArchiveTooLargeAction::Skip;
-        }
-
-        void process_file(const btu::modmanager::ModFile file) noexcept override
-        {
-            static constexpr auto k_plugin_exts = std::to_array({".esp", ".esm", ".esl"});
-            if (!btu::common::contains(k_plugin_exts, file.relative_path.extension()))
-                return;
-
-            PLOG_INFO << fmt::format("Parsing plugin {}", file.relative_path.string());
-
-            const auto absolute_path = mod_root_ / file.relative_path;
-            auto headparts           = btu::esp::list_headparts(absolute_path);
-            auto landscape_textures  = btu::esp::list_landscape_textures(absolute_path);
-
-            if (!headparts && !landscape_textures)
-            {
-                PLOGV << fmt::format("Plugin {} has no headparts or landscape textures",
-                                     file.relative_path.string());
-            }
-
-            const auto lock = std::scoped_lock(mutex_);
-
-            if (headparts)
-                result_.headparts.insert(result_.headparts.end(), headparts->begin(), headparts->end());
-
-            if (landscape_textures)
-                result_.landscape_textures.insert(result_.landscape_textures.end(),
-                                                  landscape_textures->begin(),
-                                                  landscape_textures->end());
-        }
-
-        [[nodiscard]] auto result() const noexcept -> PluginInfo { return result_; }
-
-    private:
-        std::mutex mutex_;
-        PluginInfo result_;
-        btu::Path mod_root_;
-    };
-
-    auto iterator = PluginInfoVisitor(mod.path());
-    mod.iterate(iterator);
-
-    return iterator.result();
+    return btu::bsa::Settings::get(sets.current_profile().target_game);
 }
 
-[[nodiscard]] auto get_bsa_settings(const Settings &sets) noexcept -> btu::bsa::Settings
+[[nodiscard]] auto archive_concurrency(const Profile &profile, const btu::Path &directory) noexcept -> size_t
 {
-    return btu::bsa::Settings::get(sets.current_profile().target_game);
+    if (profile.max_concurrent_archives != 0)
+        return profile.max_concurrent_archives;
+
+    return io_concurrency(detect_storage_kind(directory));
 }
 
-void Manager::unpack_directory(const std::filesystem::path &directory_path) const
+void Manager::unpack_directory(const std::filesystem::path &directory_path)
 {
     PLOG_INFO << fmt::format("Extracting archives in {}", directory_path.string());
 
@@ -132,135 +85,263 @@ void Manager::unpack_directory(const std::filesystem::path &directory_path) cons
         return;
     }
 
-    emit files_counted(archives.size());
+    count_files(archives.size());
 
-    std::ranges::for_each(archives, [this](const btu::Path &entry) {
-        const auto res = unpack(btu::bsa::UnpackSettings{
-            .file_path                = entry,
-            .remove_arch              = true,
-            .overwrite_existing_files = false,
-            .root_opt                 = nullptr,
-        });
+    const auto concurrency = archive_concurrency(settings_.current_profile(), directory_path);
+    PLOG_INFO << fmt::format("Extracting {} archives, up to {} at once", archives.size(), concurrency);
 
-        emit files_processed(entry, 1);
+    // Extracted archives are deleted, so a resumed run does not find them again: no journal is needed
+    const auto extract = [this](const btu::Path &entry) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(entry, ec);
+
+        const auto res = [&] {
+            auto timer = resources_->statistics.time(Stage::ArchiveExtraction, ec ? 0 : size);
+            return unpack(btu::bsa::UnpackSettings{
+                .file_path                = entry,
+                .remove_arch              = true,
+                .overwrite_existing_files = false,
+                .root_opt                 = nullptr,
+            });
+        }();
+
+        progress_->file_done(entry, ec ? 0 : size);
 
         switch (res)
         {
             case btu::bsa::UnpackResult::Success: break;
             case btu::bsa::UnpackResult::UnreadableArchive:
                 PLOGE << "Unreadable archive: " << entry.string();
+                ++failures_;
                 break;
             case btu::bsa::UnpackResult::FailedToDeleteArchive:
                 PLOGE << "Failed to delete archive: " << entry.string();
+                ++failures_;
                 break;
         }
-    });
-}
-
-void apply_plugin_info(PerFileSettings &sets, const PluginInfo &info)
-{
-    sets.nif.headpart_meshes.insert(sets.nif.headpart_meshes.end(),
-                                    info.headparts.begin(),
-                                    info.headparts.end());
-
-    btu::common::remove_duplicates(sets.nif.headpart_meshes);
-
-    sets.tex.landscape_textures.insert(sets.tex.landscape_textures.end(),
-                                       info.landscape_textures.begin(),
-                                       info.landscape_textures.end());
-
-    btu::common::remove_duplicates(sets.tex.landscape_textures);
-}
-
-void apply_plugin_info(Settings &sets, const PluginInfo &info)
-{
-    auto &profile = sets.current_profile();
+    };
 
-    std::ranges::for_each(profile.per_file_settings(),
-                          [&info](auto &per_file_sets) { apply_plugin_info(*per_file_sets, info); });
+    // Files are not overwritten: archives sharing files are extracted in order, so the first one listed wins
+    const auto groups = group_overlapping_archives(archives);
+    parallel_for_each(resources_->executor,
+                      Lane::Io,
+                      std::span(groups),
+                      concurrency,
+                      stop_token_,
+                      [&](const std::vector<btu::Path> &group) {
+                          for (const auto &entry : group)
+                          {
+                              if (stop_token_.stop_requested())
+                                  return;
+                              extract(entry);
+                          }
+                      });
 }
 
 // TODO: think about adding files to existing BSAs
-void Manager::pack_directory(const std::filesystem::path &directory_path) const
+void Manager::pack_directory(const std::filesystem::path &directory_path)
 {
     PLOG_INFO << fmt::format("Packing directory {}", directory_path.string());
-    emit files_counted(0);
-    emit files_processed("archive packing", 0);
+    progress_->set_current("archive packing");
 
     const auto bsa_sets = get_bsa_settings(settings_);
 
     const auto &profile = settings_.current_profile();
+    const auto matcher  = PerFileSettingsMatcher(profile.per_file_settings());
     const auto compress = settings_.current_profile().bsa_allow_compression ? btu::bsa::Compression::Yes
                                                                             : btu::bsa::Compression::No;
 
-    pack(btu::bsa::PackSettings{.input_dir     = directory_path,
-                                .game_settings = bsa_sets,
-                                .compress      = compress,
-                                .allow_file_pred =
-                                    [profile](const auto &dir, const auto &file_info) {
-                                        const auto relative_path = file_info.path().lexically_relative(dir);
-                                        const auto pack = profile.get_per_file_settings(relative_path).pack;
-
-                                        if (!pack && std::filesystem::is_regular_file(file_info))
-                                            PLOGV << fmt::format("Skipping file {} from packing",
-                                                                 relative_path.string());
-
-                                        return pack;
-                                    }})
-        .for_each([&](auto archive) {
+    const auto verification = profile.bsa_full_verification ? ArchiveVerification::Full
+                                                            : ArchiveVerification::Header;
+
+    auto &stats        = resources_->statistics;
+    auto pending_write = std::future<void>{};
+    auto packed_files  = std::vector<btu::Path>{}; // only accessed by the writing task
+    auto build_start   = std::chrono::steady_clock::now();
+
+    const auto settings = btu::bsa::PackSettings{
+        .input_dir       = directory_path,
+        .game_settings   = bsa_sets,
+        .compress        = compress,
+        .allow_file_pred = [&matcher](const auto &dir, const auto &file_info) {
+            const auto relative_path = file_info.path().lexically_relative(dir);
+            const auto pack          = matcher.find(relative_path).pack;
+
+            if (!pack && std::filesystem::is_regular_file(file_info))
+                PLOGV << fmt::format("Skipping file {} from packing", relative_path.string());
+
+            return pack;
+        }};
+
+    try
+    {
+        pack(settings).for_each([&](auto archive) {
+            stats.record(Stage::ArchiveBuilding, std::chrono::steady_clock::now() - build_start, 0, 0);
+
             if (stop_token_.stop_requested())
                 return;
 
-            try
-            {
-                write_single_archive(directory_path,
-                                     std::move(archive),
-                                     bsa_sets,
-                                     settings_.current_profile().bsa_remove_files,
-                                     settings_.current_profile().bsa_make_overrides);
-            }
-            catch (const std::exception &e)
-            {
-                PLOGE << "Failed to pack archive: " << e.what();
-            }
+            // Archive N is written and verified while archive N + 1 is being built
+            if (pending_write.valid())
+                pending_write.get();
+
+            auto write = [&, archive = std::move(archive)]() mutable {
+                try
+                {
+                    auto paths = write_single_archive(directory_path,
+                                                      std::move(archive),
+                                                      bsa_sets,
+                                                      verification,
+                                                      profile.bsa_make_overrides,
+                                                      stats);
+                    if (paths.empty())
+                        ++failures_;
+
+                    packed_files.insert(packed_files.end(),
+                                        std::make_move_iterator(paths.begin()),
+                                        std::make_move_iterator(paths.end()));
+                }
+                catch (const std::exception &e)
+                {
+                    PLOGE << "Failed to pack archive: " << e.what();
+                    ++failures_;
+                }
+            };
+            pending_write = resources_->executor.async(Lane::Io, std::move(write));
+
+            build_start = std::chrono::steady_clock::now();
         });
+    }
+    catch (...)
+    {
+        // The write task refers to the locals of this function
+        if (pending_write.valid())
+            pending_write.wait();
+        throw;
+    }
 
-    if (settings_.current_profile().bsa_make_dummy_plugins)
+    if (pending_write.valid())
+        pending_write.get();
+
+    // Files are only removed once all archives are built, as the packer may still be listing them
+    if (profile.bsa_remove_files && !packed_files.empty())
+    {
+        PLOGI << "Removing files that were packed into archives";
+        const auto count = remove_files_from_directory(directory_path, packed_files);
+        PLOGI << fmt::format("Attempted to remove {} files, {} were removed", packed_files.size(), count);
+    }
+
+    if (profile.bsa_make_dummy_plugins)
         remake_dummy_plugins(directory_path, bsa_sets);
 }
 
-void Manager::emit_progress_rate_limited(const btu::Path &path)
+void Manager::count_files(size_t count)
 {
-    ++files_processed_since_last_emissions_;
-    constexpr auto emit_every = std::chrono::milliseconds(200);
+    progress_->add_total(count);
+}
 
-    const auto now = std::chrono::steady_clock::now();
-    if (now - last_emission_.load() > emit_every)
+/// @brief Rough upper bound of the memory needed to process a file: input, decoded data and output
+[[nodiscard]] auto estimate_memory_usage(FileType type, size_t content_size) noexcept -> uint64_t
+{
+    switch (type)
     {
-        last_emission_.store(now);
-        emit files_processed(path, files_processed_since_last_emissions_);
-        files_processed_since_last_emissions_ = 0;
+        case FileType::Texture: return uint64_t{content_size} * 8; // block compressed data is decompressed
+        case FileType::Mesh: return uint64_t{content_size} * 4;
+        case FileType::Animation: return uint64_t{content_size} * 2;
     }
+    return 0;
+}
+
+/// @brief Size of a file found without reading it. Files inside archives are not on disk, their size is 0
+[[nodiscard]] auto loose_file_size(const btu::Path &loose_path) noexcept -> uint64_t
+{
+    std::error_code ec;
+    const auto size = btu::fs::file_size(loose_path, ec);
+    return ec ? 0 : size;
+}
+
+/// @brief Tells whether a file given to the transformer is loose or comes from an archive.
+/// A loose file with the same size is taken to be the file itself: a loose and an archived file sharing their
+/// path and size are almost always the same file
+[[nodiscard]] auto guess_file_source(const btu::Path &loose_path, uint64_t size) noexcept -> FileSource
+{
+    std::error_code ec;
+    const auto loose_size = btu::fs::file_size(loose_path, ec);
+    return !ec && loose_size == size ? FileSource::Loose : FileSource::Archive;
 }
 
 class ModTransformer final : public btu::modmanager::ModFolderTransformer
 {
 public:
-    using ProgressCallback = std::function<void(const btu::Path &)>;
+    /// Called once per file, with the size of its content
+    using ProgressCallback = std::function<void(const btu::Path &, uint64_t)>;
 
 private:
     Settings settings_;
     std::stop_token stop_token_;
     ProgressCallback progress_callback_;
 
+    PerFileSettingsMatcher matcher_;
+    /// Plugin records only apply to the mod they come from
+    std::shared_ptr<const PluginAssets> plugin_assets_;
+
+    RunResources &resources_;
+    std::atomic_size_t &failures_;
+
+    FileCache *file_cache_;
+    DedupeStore *dedupe_store_;
+    /// Fingerprint of each PerFileSettings, indexed like `matcher_`
+    std::vector<uint64_t> fingerprints_;
+
+    Journal *journal_;
+    const ConflictIndex *conflict_index_;
+    btu::Path mod_path_;
+
 public:
-    ModTransformer(Settings settings, std::stop_token stop_token, ProgressCallback progress_callback)
+    /// @param file_cache Files found in the cache are skipped. Can be null
+    /// @param journal Files transformed by an interrupted run are skipped. Can be null
+    /// @param conflict_index Files overridden by another mod are skipped. Can be null
+    ModTransformer(Settings settings,
+                   std::shared_ptr<const PluginAssets> plugin_assets,
+                   std::stop_token stop_token,
+                   ProgressCallback progress_callback,
+                   RunResources &resources,
+                   std::atomic_size_t &failures,
+                   FileCache *file_cache,
+                   Journal *journal,
+                   const ConflictIndex *conflict_index,
+                   btu::Path mod_path)
         : settings_(std::move(settings))
         , stop_token_(std::move(stop_token))
         , progress_callback_(std::move(progress_callback))
+        , matcher_(std::as_const(settings_).current_profile().per_file_settings())
+        , plugin_assets_(std::move(plugin_assets))
+        , resources_(resources)
+        , failures_(failures)
+        , file_cache_(settings_.current_profile().dry_run ? nullptr : file_cache)
+        , dedupe_store_(settings_.current_profile().dry_run || !settings_.current_profile().dedupe_files
+                            ? nullptr
+                            : &resources.dedupe_store)
+        , journal_(journal)
+        , conflict_index_(conflict_index)
+        , mod_path_(std::move(mod_path))
     {
+        if (file_cache_ == nullptr && dedupe_store_ == nullptr)
+            return;
+
+        fingerprints_.reserve(matcher_.size());
+        for (size_t i = 0; i < matcher_.size(); ++i)
+            fingerprints_.emplace_back(
+                settings_fingerprint(matcher_.at(i), settings_.current_profile().texture_encoder));
     }
 
+    // The matcher points into settings_
+    ModTransformer(const ModTransformer &)                     = delete;
+    auto operator=(const ModTransformer &) -> ModTransformer & = delete;
+
+    ModTransformer(ModTransformer &&)                     = delete;
+    auto operator=(ModTransformer &&) -> ModTransformer & = delete;
+
     [[nodiscard]] auto archive_too_large(const btu::Path &archive_path, ArchiveTooLargeState state) noexcept
         -> ArchiveTooLargeAction override
     {
@@ -270,6 +351,7 @@ public:
             {
                 PLOG_ERROR << fmt::format("Found archive {} that is too large", archive_path.string());
                 rename_bad_file(archive_path);
+                ++failures_;
                 break;
             }
             case ArchiveTooLargeState::AfterProcessing:
@@ -287,27 +369,202 @@ public:
         const auto path   = file.relative_path;
         auto path_for_log = btu::common::as_ascii_string(path.u8string());
 
-        auto ret = process_file(std::move(file), settings_);
+        const auto settings_index = matcher_.find_index(path);
+        const auto plugin_sets    = plugin_assets_->apply(path, matcher_.at(settings_index));
+        const auto &file_sets     = plugin_sets ? *plugin_sets : matcher_.at(settings_index);
+
+        // Files that will not be processed are not read, let alone hashed
+        const auto type    = guess_file_type(path);
+        const bool dry_run = settings_.current_profile().dry_run;
+        if (!type || optimize_type(*type, file_sets, dry_run) == OptimizeType::None)
+        {
+            progress_callback_(path, 0);
+            return std::nullopt;
+        }
+
+        // The game never loads this copy, it is not even read
+        if (conflict_index_ != nullptr && conflict_index_->is_overridden(mod_path_, path))
+        {
+            const auto size = loose_file_size(mod_path_ / path);
+            PLOGV << fmt::format("File {} is overridden by another mod, skipping", path_for_log);
+            progress_callback_(path, size);
+            resources_.statistics.record_overridden(size);
+            return std::nullopt;
+        }
+
+        // Loose files are reserved for before being read, using their size on disk. Files from archives are
+        // already held in memory by the archive, they are reserved for once their size is known
+        auto reservation   = std::optional<MemoryBudget::Reservation>{};
+        const auto reserve = [&](uint64_t size) {
+            auto granted = resources_.memory_budget.reserve(estimate_memory_usage(*type, size), stop_token_);
+            if (granted)
+                reservation.emplace(std::move(*granted));
+            return granted.has_value();
+        };
+
+        if (const auto size = loose_file_size(mod_path_ / path); size != 0 && !reserve(size))
+            return std::nullopt;
+
+        const bool has_content  = file.content->has_value();
+        const auto content_size = has_content ? file.content->value().size() : 0;
+
+        const bool use_cache  = file_cache_ != nullptr && has_content;
+        const bool use_dedupe = dedupe_store_ != nullptr && has_content;
+
+        // Only a resumed run can find files in the journal
+        const bool check_journal = journal_ != nullptr && journal_->has_previous_files() && has_content;
+
+        const auto content_hash = use_cache || use_dedupe || check_journal
+                                      ? std::optional(hash_bytes(file.content->value()))
+                                      : std::nullopt;
+
+        // Only needed for the journal, and costs a file system query
+        const auto source = [&] { return guess_file_source(mod_path_ / path, content_size); };
+
+        // Files referenced by a plugin are processed differently
+        const auto fingerprint = hash_combine(fingerprints_.empty() ? 0 : fingerprints_[settings_index],
+                                              plugin_sets.has_value() ? 1 : 0);
+
+        // Same as FileCache::make_key, without hashing the content again
+        const auto key = use_cache ? std::optional(hash_combine(*content_hash, fingerprint)) : std::nullopt;
+
+        // The output is hashed once, for both the file cache and the journal
+        const auto record_output = [&](std::span<const std::byte> output) {
+            if (!key && journal_ == nullptr)
+                return;
 
-        progress_callback_(path);
+            const auto output_hash = hash_bytes(output);
+            if (key)
+                file_cache_->insert(hash_combine(output_hash, fingerprint));
+            if (journal_ != nullptr)
+                journal_->record_file_transformed(mod_path_ / path, source(), output_hash);
+        };
+
+        if (key && file_cache_->contains(*key))
+        {
+            PLOGV << fmt::format("File {} is unchanged since it was last optimized, skipping", path_for_log);
+            progress_callback_(path, content_size);
+            return std::nullopt;
+        }
+
+        if (check_journal && journal_->is_file_transformed(mod_path_ / path, source(), *content_hash))
+        {
+            PLOGV << fmt::format("File {} was optimized by the interrupted run, skipping", path_for_log);
+            progress_callback_(path, content_size);
+            return std::nullopt;
+        }
+
+        auto claim = std::optional<DedupeStore::Claim>{};
+        if (use_dedupe)
+        {
+            // Some processing depends on the path of the file, such as for landscape textures. Identical
+            // files are almost always the same asset shipped by several mods, so they share their path anyway
+            const auto path_hash = hash_string(
+                btu::common::as_ascii_string(btu::common::to_lower(path.generic_u8string())));
+            const auto dedupe_key = hash_combine(hash_combine(*content_hash, fingerprint), path_hash);
+
+            auto lookup = dedupe_store_->acquire(dedupe_key);
+            if (auto *result = std::get_if<std::shared_future<DedupeStore::Result>>(&lookup))
+            {
+                // Waiting for the identical file needs no memory
+                reservation.reset();
+
+                if (auto reused = reuse_duplicate(*result, path_for_log, key))
+                {
+                    progress_callback_(path, content_size);
+                    resources_.statistics.record_duplicate(content_size);
+
+                    if (*reused)
+                        record_output(**reused);
+
+                    return std::move(*reused);
+                }
+            }
+            else
+            {
+                claim.emplace(std::get<DedupeStore::Claim>(std::move(lookup)));
+            }
+        }
+
+        if (!reservation && has_content && !reserve(content_size))
+            return std::nullopt;
+
+        auto ret = process_file(std::move(file), file_sets, dry_run, resources_);
+
+        progress_callback_(path, content_size);
 
         if (!ret)
         {
-            if (ret.error() != k_error_no_work_required)
+            const bool failed = ret.error() != k_error_no_work_required;
+            if (failed)
             {
                 PLOG_ERROR << fmt::format("Failed to process file {}: {}",
                                           path_for_log,
                                           ret.error().message());
+                ++failures_;
             }
+            else if (key)
+            {
+                file_cache_->insert(*key);
+            }
+
+            if (claim)
+                claim->publish_unchanged(failed);
 
             // TODO: rename bad files
 
             return std::nullopt;
         }
 
+        if (claim)
+            claim->publish(*ret);
+
+        record_output(*ret);
         return std::move(*ret);
     }
 
+    /// @brief Waits for an identical file to be processed, and records its result as this file's
+    /// @return The content to write, which may be nothing. Nothing at all if the file must be processed
+    [[nodiscard]] auto reuse_duplicate(const std::shared_future<DedupeStore::Result> &future,
+                                       const std::string &path_for_log,
+                                       std::optional<uint64_t> key)
+        -> std::optional<std::optional<std::vector<std::byte>>>
+    {
+        const auto result = [&]() -> std::optional<DedupeStore::Result> {
+            try
+            {
+                return future.get();
+            }
+            catch (const std::future_error &)
+            {
+                return std::nullopt; // the identical file was not processed
+            }
+        }();
+
+        if (!result)
+            return std::nullopt;
+
+        if (result->failed)
+        {
+            PLOG_ERROR << fmt::format("Failed to process file {}: an identical file could not be processed",
+                                      path_for_log);
+            ++failures_;
+            return std::optional<std::vector<std::byte>>();
+        }
+
+        if (!result->output)
+        {
+            PLOGV << fmt::format("File {} is identical to a file that needed no work, skipping",
+                                 path_for_log);
+            if (key)
+                file_cache_->insert(*key);
+            return std::optional<std::vector<std::byte>>();
+        }
+
+        PLOGV << fmt::format("File {} is identical to a file already optimized, reusing it", path_for_log);
+        return std::optional(std::vector<std::byte>(*result->output));
+    }
+
     [[nodiscard]] auto stop_requested() const noexcept -> bool override
     {
         return stop_token_.stop_requested();
@@ -317,6 +574,7 @@ public:
     {
         PLOGE << fmt::format("Failed to read archive {}", archive_path.string());
         rename_bad_file(archive_path);
+        ++failures_;
     }
 
     // TODO: think more thoroughly about these error handling functions
@@ -327,6 +585,7 @@ public:
         PLOGE << fmt::format("Failed to write transformed file {}. After processing, file size was {}",
                              relative_path.string(),
                              content.size());
+        ++failures_;
     }
 
     void failed_to_read_transformed_file(const btu::Path &relative_path,
@@ -335,6 +594,7 @@ public:
         PLOGE << fmt::format("Failed to read transformed file {}. After processing, file size was {}",
                              relative_path.string(),
                              content.size());
+        ++failures_;
     }
 
     void failed_to_write_archive(const btu::Path &old_archive_path,
@@ -343,47 +603,108 @@ public:
         PLOGE << fmt::format("Failed to write archive {} to {}",
                              old_archive_path.string(),
                              new_archive_path.string());
+        ++failures_;
     }
 };
 
 void Manager::process_single_mod(const btu::Path &path)
 {
+    if (journal_ && journal_->is_mod_done(path))
+    {
+        PLOG_INFO << fmt::format("Mod {} was completed by the interrupted run, skipping", path.string());
+        return;
+    }
+
+    // Dry runs only read file headers, loading whole files would take too long on large libraries
+    if (analysis_report_)
+    {
+        const auto &profile = std::as_const(settings_).current_profile();
+        const auto matcher  = PerFileSettingsMatcher(profile.per_file_settings());
+
+        analysis_report_->add(analyze_mod(
+            path,
+            matcher,
+            resources_->executor,
+            archive_concurrency(profile, path),
+            stop_token_,
+            [this](size_t count) { count_files(count); },
+            [this](const btu::Path &file_path) { progress_->file_done(file_path, 0); }));
+        return;
+    }
+
     const auto bsa_sets = get_bsa_settings(settings_);
     auto mod            = btu::modmanager::ModFolder(path, bsa_sets);
 
-    PLOG_INFO << "Parsing plugins...";
-    const auto plugin_info = get_plugin_info(mod);
-    apply_plugin_info(settings_, plugin_info);
+    PLOG_INFO << fmt::format("Parsing plugins of {}...", path.string());
+    auto plugin_assets = [&] {
+        auto timer = resources_->statistics.time(Stage::PluginParsing);
+        return std::make_shared<const PluginAssets>(
+            scan_plugins(mod.path(), plugin_index_.get(), resources_->executor, stop_token_));
+    }();
 
     if (stop_token_.stop_requested())
         return;
 
-    if (settings_.current_profile().bsa_operation == BsaOperation::Extract
-        && !settings_.current_profile().dry_run)
+    if (settings_.current_profile().bsa_operation == BsaOperation::Extract)
         unpack_directory(mod.path());
 
     const auto size = mod.size();
-    PLOG_INFO << fmt::format("Found {} files", size);
+    PLOG_INFO << fmt::format("Found {} files in {}", size, path.string());
+
+    count_files(size);
+
+    auto transformer = ModTransformer{settings_,
+                                      std::move(plugin_assets),
+                                      stop_token_,
+                                      [this](const btu::Path &path, uint64_t bytes) {
+                                          progress_->file_done(path, bytes);
+                                      },
+                                      *resources_,
+                                      failures_,
+                                      file_cache_.get(),
+                                      journal_.get(),
+                                      conflict_index_.get(),
+                                      mod.path()};
 
-    emit files_counted(size);
+    mod.transform(transformer);
 
-    auto transformer = ModTransformer{settings_, stop_token_, [this](const btu::Path &path) {
-                                          emit_progress_rate_limited(path);
-                                      }};
+    if (journal_)
+        journal_->flush();
 
-    mod.transform(transformer);
     if (stop_token_.stop_requested())
         return;
 
-    if (settings_.current_profile().bsa_operation == BsaOperation::Create
-        && !settings_.current_profile().dry_run)
+    const bool already_packed = journal_ && journal_->are_archives_packed(mod.path());
+    if (settings_.current_profile().bsa_operation == BsaOperation::Create && !already_packed)
+    {
         pack_directory(mod.path());
+        if (journal_ && !stop_token_.stop_requested())
+            journal_->record_archives_packed(mod.path());
+    }
+
+    if (journal_ && !stop_token_.stop_requested())
+        journal_->record_mod_done(path);
+}
+
+[[nodiscard]] auto mod_concurrency(const Profile &profile) noexcept -> size_t
+{
+    if (profile.max_concurrent_mods != 0)
+        return profile.max_concurrent_mods;
+
+    // Each mod is already transformed in parallel. Running a few at once keeps the disk busy while
+    // another mod is CPU-bound
+    constexpr size_t threads_per_mod = 8;
+    constexpr size_t max_auto_mods   = 4;
+    return std::clamp(size_t{std::thread::hardware_concurrency()} / threads_per_mod,
+                      size_t{1},
+                      max_auto_mods);
 }
 
 void Manager::process_several_mods(const btu::Path &path)
 {
     PLOGI << "Processing several mods in " << path.string();
-    switch (btu::modmanager::find_manager(path))
+    const auto manager = btu::modmanager::find_manager(path);
+    switch (manager)
     {
         case btu::modmanager::ModManager::Vortex:
             PLOGI << "This directory appears to be a Vortex mod directory";
@@ -400,27 +721,111 @@ void Manager::process_several_mods(const btu::Path &path)
             break;
     }
 
-    // TODO: improve handling per mod manager
-    const auto mod_folders = flux::from_range(btu::fs::directory_iterator(path)).filter([](const auto &entry) {
-        return btu::fs::is_directory(entry.path());
-    });
+    // Mods the game does not load are skipped before reading any of their files
+    const auto &profile = std::as_const(settings_).current_profile();
+    auto selection      = select_mods(path, manager, profile.mods_blacklist);
+    auto &mod_folders   = selection.mods;
 
-    for (const auto &mod_folder : mod_folders)
+    // Packed loose files lose their precedence over archives, the load order decides which copy is loaded
+    const bool packing = profile.bsa_operation == BsaOperation::Create;
+    if (selection.by_priority && profile.skip_overridden_files && !profile.dry_run && !packing)
     {
-        if (stop_token_.stop_requested())
-            return;
-        process_single_mod(mod_folder);
+        PLOGI << "Looking for files overridden by other mods";
+        conflict_index_ = std::make_unique<ConflictIndex>(
+            ConflictIndex::build(mod_folders,
+                                 get_bsa_settings(settings_),
+                                 profile.bsa_operation == BsaOperation::Extract,
+                                 resources_->executor,
+                                 archive_concurrency(profile, path),
+                                 stop_token_));
+        PLOGI << fmt::format("Found {} files provided by several mods", conflict_index_->size());
     }
+
+    const auto concurrency = mod_concurrency(profile);
+    PLOGI << fmt::format("Found {} mods. Processing up to {} at once", mod_folders.size(), concurrency);
+
+    const auto process_mod = [this](const btu::Path &mod_folder) {
+        try
+        {
+            process_single_mod(mod_folder);
+        }
+        catch (const std::exception &e)
+        {
+            PLOGE << fmt::format("Failed to process mod {}: {}", mod_folder.string(), e.what());
+            ++failures_;
+        }
+        catch (...)
+        {
+            PLOGE << fmt::format("Failed to process mod {}: unknown error", mod_folder.string());
+            ++failures_;
+        }
+    };
+
+    // A mod mostly waits for its files to be transformed. Mods are driven from their own threads rather than
+    // from the CPU lane, so they do not hold CPU lane threads while waiting
+    auto next_mod    = std::atomic_size_t{0};
+    const auto drive = [&] {
+        while (!stop_token_.stop_requested())
+        {
+            const auto index = next_mod.fetch_add(1);
+            if (index >= mod_folders.size())
+                return;
+
+            process_mod(mod_folders[index]);
+        }
+    };
+
+    // The calling thread is one of the drivers
+    auto drivers = std::vector<std::jthread>{};
+    for (size_t i = 1; i < std::min(concurrency, mod_folders.size()); ++i)
+        drivers.emplace_back(drive);
+
+    drive();
+}
+
+auto Manager::failure_count() const noexcept -> size_t
+{
+    return failures_;
 }
 
-void Manager::run_optimization(Settings settings, std::stop_token stop_token)
+void Manager::run_optimization(Settings settings, std::stop_token stop_token, RunOptions options)
 {
     settings_   = std::move(settings);
     stop_token_ = std::move(stop_token);
 
+    failures_ = 0;
+
+    constexpr auto k_progress_interval = std::chrono::milliseconds(200);
+
+    const auto publish = [this](const ProgressStatus &status) { emit progress(status); };
+    progress_          = std::make_unique<ProgressTracker>(k_progress_interval, publish);
+
+    resources_ = std::make_unique<RunResources>(settings_.current_profile());
+
+    plugin_index_ = std::make_unique<PluginIndex>(Settings::state_directory() / PluginIndex::k_file_name);
+
+    analysis_report_.reset();
+    journal_.reset();
+    if (settings_.current_profile().dry_run)
+        analysis_report_ = std::make_unique<AnalysisReport>();
+    else
+        journal_ = std::make_unique<Journal>(Settings::state_directory() / Journal::k_file_name,
+                                             settings_.current_profile().input_path,
+                                             options.resume);
+
+    conflict_index_.reset();
+
+    file_cache_.reset();
+    if (settings_.current_profile().use_file_cache)
+    {
+        file_cache_ = std::make_unique<FileCache>(Settings::state_directory() / FileCache::k_file_name);
+        PLOG_INFO << fmt::format("Loaded file cache with {} entries", file_cache_->size());
+    }
+
     PLOG_INFO << fmt::format("Processing mod: {}", settings_.current_profile().input_path.string());
 
-    const auto start_time = std::chrono::system_clock::now();
+    const auto start_time   = std::chrono::system_clock::now();
+    const auto steady_start = std::chrono::steady_clock::now();
     PLOG_INFO << fmt::format("Beginning. Start time: {}", start_time);
 
     switch (settings_.current_profile().optimization_mode)
@@ -431,9 +836,38 @@ void Manager::run_optimization(Settings settings, std::stop_token stop_token)
             break;
     }
 
+    // Saved once, also after a stop: saving after each mod would serialize them again and again
+    if (!plugin_index_->save())
+        PLOGW << "Failed to save the plugin index";
+
+    if (file_cache_ && !file_cache_->save())
+        PLOGW << "Failed to save the file cache";
+
     const auto end_time     = std::chrono::system_clock::now();
     const auto elapsed_time = std::chrono::duration_cast<std::chrono::seconds>(end_time - start_time).count();
     PLOG_INFO << fmt::format("Finished. End time: {}. Elapsed time: {}s", end_time, elapsed_time);
+
+    constexpr uint64_t k_bytes_per_mb = 1024 * 1024;
+    PLOG_INFO << fmt::format("Peak in-flight bytes: {} MB (budget: {} MB)",
+                             resources_->memory_budget.peak() / k_bytes_per_mb,
+                             resources_->memory_budget.limit() / k_bytes_per_mb);
+
+    const auto reports_directory = Settings::state_directory() / "reports";
+    const auto timestamp         = fmt::format("{:%Y%m%d-%H%M%S}",
+                                       std::chrono::floor<std::chrono::seconds>(start_time));
+    resources_->statistics.report(reports_directory / fmt::format("run-{}.json", timestamp),
+                                  std::chrono::steady_clock::now() - steady_start);
+
+    const auto analysis_path = reports_directory / fmt::format("dry-run-{}.json", timestamp);
+    if (analysis_report_ && !analysis_report_->write(analysis_path))
+        PLOGW << "Failed to write the dry run report to " << analysis_path.string();
+
+    // An interrupted run keeps its journal, so it can be resumed
+    if (journal_ && !stop_token_.stop_requested())
+        journal_->finish();
+
+    progress_.reset(); // publishes the final totals
+
     emit end();
 }
 } // namespace cao
@@ -4,13 +4,27 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 #pragma once
 
+#include "analysis.hpp"
+#include "conflict_index.hpp"
+#include "file_cache.hpp"
+#include "journal.hpp"
+#include "plugin_index.hpp"
+#include "progress.hpp"
+#include "run_resources.hpp"
 #include "settings/settings.hpp"
 
 #include <QObject>
 #include <QString>
+#include <memory>
 #include <thread>
 
 namespace cao {
+struct RunOptions
+{
+    /// Skip the work done by the previous run, if it was interrupted
+    bool resume = false;
+};
+
 /// \brief The Manager class is responsible for the optimization process.
 /// It is the main class of the program and the only "backend" class to be used by the GUI.
 class Manager final : public QObject
@@ -18,26 +32,39 @@ class Manager final : public QObject
     Q_OBJECT
 
 public:
-    void run_optimization(Settings settings, std::stop_token stop_token);
+    void run_optimization(Settings settings, std::stop_token stop_token, RunOptions options = {});
+
+    /// Number of files and archives that could not be processed during the last run
+    [[nodiscard]] auto failure_count() const noexcept -> size_t;
 
 private:
     Settings settings_;
     std::stop_token stop_token_;
+    std::unique_ptr<FileCache> file_cache_;
+    std::unique_ptr<PluginIndex> plugin_index_;
+    /// Only set in several mods mode, when the priority of the mods is known
+    std::unique_ptr<ConflictIndex> conflict_index_;
+    /// Only set for dry runs
+    std::unique_ptr<AnalysisReport> analysis_report_;
+    /// Not set for dry runs
+    std::unique_ptr<Journal> journal_;
+    std::unique_ptr<RunResources> resources_;
 
     void process_single_mod(const btu::Path &path);
     void process_several_mods(const btu::Path &path);
 
-    void unpack_directory(const std::filesystem::path &directory_path) const;
-    void pack_directory(const std::filesystem::path &directory_path) const;
+    void unpack_directory(const std::filesystem::path &directory_path);
+    void pack_directory(const std::filesystem::path &directory_path);
+
+    /// Adds `count` to the number of files of the run
+    void count_files(size_t count);
+    std::atomic_size_t failures_;
 
-    void emit_progress_rate_limited(const btu::Path &path);
-    // TODO: would a mutex be better?
-    std::atomic<std::chrono::steady_clock::time_point> last_emission_;
-    std::atomic_uint32_t files_processed_since_last_emissions_;
+    std::unique_ptr<ProgressTracker> progress_;
 
 signals:
-    void files_counted(size_t count) const;
-    void files_processed(std::filesystem::path last_relative_path, size_t count_since_last) const;
+    /// Emitted at a fixed interval from a dedicated thread, and once more with the final totals
+    void progress(const cao::ProgressStatus &status) const;
     void end() const;
 };
 } // namespace cao
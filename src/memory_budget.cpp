@@ -0,0 +1,104 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "memory_budget.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace cao {
+#ifdef _WIN32
+auto physical_memory() noexcept -> std::optional<uint64_t>
+{
+    auto status     = MEMORYSTATUSEX{};
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status) == 0)
+        return std::nullopt;
+
+    return status.ullTotalPhys;
+}
+#else
+auto physical_memory() noexcept -> std::optional<uint64_t>
+{
+    const auto pages     = sysconf(_SC_PHYS_PAGES);
+    const auto page_size = sysconf(_SC_PAGE_SIZE);
+    if (pages <= 0 || page_size <= 0)
+        return std::nullopt;
+
+    return static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size);
+}
+#endif
+
+MemoryBudget::MemoryBudget(uint64_t limit) noexcept
+    : limit_(limit)
+{
+}
+
+MemoryBudget::Reservation::Reservation(MemoryBudget &budget, uint64_t bytes) noexcept
+    : budget_(&budget)
+    , bytes_(bytes)
+{
+}
+
+MemoryBudget::Reservation::Reservation(Reservation &&other) noexcept
+    : budget_(std::exchange(other.budget_, nullptr))
+    , bytes_(other.bytes_)
+{
+}
+
+MemoryBudget::Reservation::~Reservation()
+{
+    if (budget_ != nullptr)
+        budget_->release(bytes_);
+}
+
+auto MemoryBudget::reserve(uint64_t bytes, std::stop_token stop_token) -> std::optional<Reservation>
+{
+    auto lock = std::unique_lock(mutex_);
+
+    const auto ticket = next_ticket_++;
+    waiting_.push_back(ticket);
+
+    const auto fits = [&] {
+        return waiting_.front() == ticket
+               && (limit_ == 0 || in_flight_ == 0 || in_flight_ + bytes <= limit_);
+    };
+    const bool granted = released_.wait(lock, stop_token, fits);
+
+    // Either way, the next request may now be at the front of the queue
+    waiting_.erase(std::ranges::find(waiting_, ticket));
+    released_.notify_all();
+
+    if (!granted)
+        return std::nullopt;
+
+    in_flight_ += bytes;
+    peak_ = std::max(peak_, in_flight_);
+    return Reservation(*this, bytes);
+}
+
+auto MemoryBudget::peak() const noexcept -> uint64_t
+{
+    const auto lock = std::scoped_lock(mutex_);
+    return peak_;
+}
+
+void MemoryBudget::release(uint64_t bytes) noexcept
+{
+    {
+        const auto lock = std::scoped_lock(mutex_);
+        in_flight_ -= bytes;
+    }
+    released_.notify_all();
+}
+} // namespace cao
@@ -0,0 +1,69 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+
+namespace cao {
+/// @brief Total physical memory of the machine, or nothing if it cannot be found
+[[nodiscard]] auto physical_memory() noexcept -> std::optional<uint64_t>;
+
+/// @brief Admission control on the memory used by files being processed.
+/// A file is only started when its estimated memory use fits in what is left of the budget.
+/// A file larger than the whole budget is still processed, but alone, so the run cannot deadlock.
+/// Reservations are granted in the order they were requested, so small files cannot starve a large one.
+class MemoryBudget
+{
+public:
+    /// @param limit In bytes. 0 means no limit
+    explicit MemoryBudget(uint64_t limit) noexcept;
+
+    /// @brief Gives memory back to the budget when destroyed
+    class Reservation
+    {
+    public:
+        Reservation(MemoryBudget &budget, uint64_t bytes) noexcept;
+
+        Reservation(const Reservation &)                     = delete;
+        auto operator=(const Reservation &) -> Reservation & = delete;
+
+        Reservation(Reservation &&other) noexcept;
+        auto operator=(Reservation &&) -> Reservation & = delete;
+
+        ~Reservation();
+
+    private:
+        MemoryBudget *budget_;
+        uint64_t bytes_;
+    };
+
+    /// @brief Waits until `bytes` fit in the budget and every earlier request was granted
+    /// @return Nothing if a stop was requested while waiting
+    [[nodiscard]] auto reserve(uint64_t bytes, std::stop_token stop_token) -> std::optional<Reservation>;
+
+    [[nodiscard]] auto limit() const noexcept -> uint64_t { return limit_; }
+
+    /// @brief Highest amount of memory reserved at once
+    [[nodiscard]] auto peak() const noexcept -> uint64_t;
+
+private:
+    void release(uint64_t bytes) noexcept;
+
+    uint64_t limit_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any released_;
+    /// Tickets of the requests waiting to be granted, oldest first
+    std::deque<uint64_t> waiting_;
+    uint64_t next_ticket_ = 0;
+    uint64_t in_flight_   = 0;
+    uint64_t peak_        = 0;
+};
+} // namespace cao
@@ -0,0 +1,271 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "mod_selection.hpp"
+
+#include <btu/common/string.hpp>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <plog/Log.h>
+#include <sago/platform_folders.h>
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+namespace cao {
+/// @brief Reads a text file line by line, without the line endings
+[[nodiscard]] auto read_lines(const btu::Path &file_path) -> std::optional<std::vector<std::u8string>>
+{
+    std::ifstream stream(file_path, std::ios::binary);
+    if (!stream)
+        return std::nullopt;
+
+    auto lines = std::vector<std::u8string>{};
+    for (std::string line; std::getline(stream, line);)
+    {
+        if (line.ends_with('\r'))
+            line.pop_back();
+        lines.emplace_back(line.begin(), line.end());
+    }
+    return lines;
+}
+
+/// @brief Value of a key of an ini file, without the @ByteArray() wrapper Qt writes around some of them
+[[nodiscard]] auto ini_value(std::span<const std::u8string> lines, std::u8string_view key)
+    -> std::optional<std::u8string>
+{
+    constexpr auto k_byte_array = std::u8string_view(u8"@ByteArray(");
+
+    for (const auto &line : lines)
+    {
+        if (!line.starts_with(key) || line.size() == key.size() || line[key.size()] != u8'=')
+            continue;
+
+        auto value = std::u8string_view(line).substr(key.size() + 1);
+        if (value.starts_with(k_byte_array) && value.ends_with(u8')'))
+            value = value.substr(k_byte_array.size(), value.size() - k_byte_array.size() - 1);
+        return std::u8string(value);
+    }
+    return std::nullopt;
+}
+
+/// @brief Where an MO2 instance keeps its mods and profiles, and which profile it had selected when it was
+/// last closed
+struct Mo2Instance
+{
+    btu::Path mods_directory;
+    btu::Path profiles_directory;
+    std::u8string selected_profile;
+};
+
+/// @brief Reads the ModOrganizer.ini of an instance. Directories that were not customized are in the base
+/// directory, which is the instance directory unless customized too
+[[nodiscard]] auto read_mo2_instance(const btu::Path &instance_directory) -> std::optional<Mo2Instance>
+{
+    constexpr auto k_base_dir = std::u8string_view(u8"%BASE_DIR%");
+
+    const auto lines = read_lines(instance_directory / "ModOrganizer.ini");
+    if (!lines)
+        return std::nullopt;
+
+    const auto base_value     = ini_value(*lines, u8"base_directory");
+    const auto base_directory = base_value ? btu::Path(*base_value) : instance_directory;
+
+    const auto directory = [&](std::u8string_view key, std::u8string_view default_value) {
+        const auto value = ini_value(*lines, key).value_or(std::u8string(default_value));
+        if (!value.starts_with(k_base_dir))
+            return btu::Path(value);
+
+        auto relative = std::u8string_view(value).substr(k_base_dir.size());
+        while (relative.starts_with(u8'/') || relative.starts_with(u8'\\'))
+            relative.remove_prefix(1);
+        return base_directory / relative;
+    };
+
+    return Mo2Instance{
+        .mods_directory     = directory(u8"mod_directory", u8"%BASE_DIR%/mods"),
+        .profiles_directory = directory(u8"profiles_directory", u8"%BASE_DIR%/profiles"),
+        .selected_profile   = ini_value(*lines, u8"selected_profile").value_or(u8"Default"),
+    };
+}
+
+/// @brief Finds the instance whose mods are in `mods_directory`. A portable instance usually holds its mods
+/// directory, while global instances live in the local application data, wherever their mods are
+[[nodiscard]] auto find_mo2_instance(const btu::Path &mods_directory) -> Mo2Instance
+{
+    auto candidates = std::vector<btu::Path>{mods_directory.parent_path()};
+    try
+    {
+        const auto global_instances = btu::Path(sago::getCacheDir()) / "ModOrganizer";
+
+        std::error_code ec;
+        for (const auto &entry : btu::fs::directory_iterator(global_instances, ec))
+            if (entry.is_directory(ec))
+                candidates.emplace_back(entry.path());
+    }
+    catch (const std::exception &)
+    {
+        // Only portable instances can be found
+    }
+
+    for (const auto &candidate : candidates)
+    {
+        auto instance = read_mo2_instance(candidate);
+
+        std::error_code ec;
+        if (instance && btu::fs::equivalent(instance->mods_directory, mods_directory, ec))
+            return std::move(*instance);
+    }
+
+    // Assume a portable instance with the default settings
+    return Mo2Instance{
+        .mods_directory     = mods_directory,
+        .profiles_directory = mods_directory.parent_path() / "profiles",
+        .selected_profile   = u8"Default",
+    };
+}
+
+auto read_mo2_modlist(const btu::Path &mods_directory) -> std::optional<std::vector<std::u8string>>
+{
+    const auto instance     = find_mo2_instance(mods_directory);
+    const auto modlist_path = instance.profiles_directory / instance.selected_profile / "modlist.txt";
+
+    const auto lines = read_lines(modlist_path);
+    if (!lines)
+    {
+        PLOGW << fmt::format("Could not read the MO2 mod list {}", modlist_path.string());
+        return std::nullopt;
+    }
+
+    PLOGI << fmt::format("Reading mod list of MO2 profile {}",
+                         btu::common::as_ascii_string(instance.selected_profile));
+
+    // Enabled mods start with '+', disabled ones with '-', and mods MO2 does not manage with '*'.
+    // Separators are empty mods used to group the others
+    auto mods = std::vector<std::u8string>{};
+    for (const auto &line : *lines)
+        if (line.starts_with(u8'+') && !line.ends_with(u8"_separator"))
+            mods.emplace_back(line.substr(1));
+
+    // The list starts with the highest priority
+    std::ranges::reverse(mods);
+    return mods;
+}
+
+auto read_vortex_manifest(const btu::Path &staging_directory) -> std::optional<std::vector<std::u8string>>
+{
+    auto mods     = std::vector<std::u8string>{};
+    auto seen     = std::unordered_set<std::u8string>{};
+    bool any_read = false;
+
+    std::error_code ec;
+    for (const auto &entry : btu::fs::directory_iterator(staging_directory, ec))
+    {
+        const auto file_name = entry.path().filename().u8string();
+        if (!file_name.starts_with(u8"vortex.deployment") || !file_name.ends_with(u8".json"))
+            continue;
+
+        try
+        {
+            std::ifstream stream(entry.path());
+            const auto manifest = nlohmann::json::parse(stream);
+
+            for (const auto &file : manifest.at("files"))
+            {
+                const auto source = file.at("source").get<std::string>();
+                auto name         = std::u8string(source.begin(), source.end());
+                if (seen.insert(name).second)
+                    mods.emplace_back(std::move(name));
+            }
+            any_read = true;
+        }
+        catch (const std::exception &e)
+        {
+            PLOGW << fmt::format("Ignoring unreadable Vortex manifest {}: {}",
+                                 entry.path().string(),
+                                 e.what());
+        }
+    }
+
+    if (!any_read)
+        return std::nullopt;
+
+    // Vortex does not store a priority order, its manifests only tell which mod won each conflict
+    std::ranges::sort(mods);
+    return mods;
+}
+
+auto is_blacklisted(std::u8string_view mod_name, std::span<const std::u8string> blacklist) -> bool
+{
+    const auto name = btu::common::to_lower(mod_name);
+    return std::ranges::any_of(blacklist, [&name](const std::u8string &pattern) {
+        return btu::common::str_match(name, pattern);
+    });
+}
+
+auto select_mods(const btu::Path &mods_directory,
+                 btu::modmanager::ModManager manager,
+                 std::span<const std::u8string> blacklist) -> ModSelection
+{
+    const auto enabled = [&]() -> std::optional<std::vector<std::u8string>> {
+        switch (manager)
+        {
+            case btu::modmanager::ModManager::MO2: return read_mo2_modlist(mods_directory);
+            case btu::modmanager::ModManager::Vortex: return read_vortex_manifest(mods_directory);
+            case btu::modmanager::ModManager::ManualForced:
+            case btu::modmanager::ModManager::None: return std::nullopt;
+        }
+        return std::nullopt;
+    }();
+
+    auto names = [&] {
+        if (enabled)
+            return *enabled;
+
+        if (manager == btu::modmanager::ModManager::MO2 || manager == btu::modmanager::ModManager::Vortex)
+            PLOGW << "Could not read which mods are enabled in the mod manager. Processing all of them";
+
+        auto all = std::vector<std::u8string>{};
+        std::error_code ec;
+        for (const auto &entry : btu::fs::directory_iterator(mods_directory, ec))
+            if (entry.is_directory(ec))
+                all.emplace_back(entry.path().filename().u8string());
+
+        std::ranges::sort(all);
+        return all;
+    }();
+
+    // Patterns are lowercased once, rather than for every mod
+    auto lowercase_blacklist = std::vector<std::u8string>{};
+    lowercase_blacklist.reserve(blacklist.size());
+    for (const auto &pattern : blacklist)
+        lowercase_blacklist.emplace_back(btu::common::to_lower(pattern));
+
+    // Vortex does not give an order
+    const bool by_priority = enabled && manager == btu::modmanager::ModManager::MO2;
+    auto selection         = ModSelection{.mods = {}, .by_priority = by_priority};
+    size_t blacklisted     = 0;
+    for (const auto &name : names)
+    {
+        if (is_blacklisted(name, lowercase_blacklist))
+        {
+            PLOGV << fmt::format("Skipping blacklisted mod {}", btu::common::as_ascii_string(name));
+            ++blacklisted;
+            continue;
+        }
+
+        auto path = mods_directory / name;
+        std::error_code ec;
+        if (btu::fs::is_directory(path, ec))
+            selection.mods.emplace_back(std::move(path));
+    }
+
+    if (blacklisted != 0)
+        PLOGI << fmt::format("Skipping {} blacklisted mods", blacklisted);
+
+    return selection;
+}
+} // namespace cao
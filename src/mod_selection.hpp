@@ -0,0 +1,46 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <btu/common/path.hpp>
+#include <btu/modmanager/mod_manager.hpp>
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cao {
+/// @brief Names of the mods enabled in the selected profile of the MO2 instance owning `mods_directory`,
+/// lowest priority first. The instance is looked for next to `mods_directory`, then among the global
+/// instances, and its custom directories are honored
+/// @return Nothing if the profile cannot be found or read
+[[nodiscard]] auto read_mo2_modlist(const btu::Path &mods_directory)
+    -> std::optional<std::vector<std::u8string>>;
+
+/// @brief Names of the mods that have files deployed according to the Vortex manifests of `staging_directory`
+/// @return Nothing if there is no readable manifest
+[[nodiscard]] auto read_vortex_manifest(const btu::Path &staging_directory)
+    -> std::optional<std::vector<std::u8string>>;
+
+/// @brief Whether a mod name matches one of the wildcard patterns of `blacklist`, ignoring case
+/// @param blacklist Lowercase patterns
+[[nodiscard]] auto is_blacklisted(std::u8string_view mod_name, std::span<const std::u8string> blacklist)
+    -> bool;
+
+struct ModSelection
+{
+    std::vector<btu::Path> mods;
+    /// Whether `mods` is ordered by the priority given by the mod manager, rather than alphabetically
+    bool by_priority = false;
+};
+
+/// @brief Mods of `mods_directory` that the game loads, lowest priority first.
+/// Mods disabled in the mod manager or matching `blacklist` are left out. If the mod manager state cannot be
+/// read, every mod is kept, in alphabetical order
+[[nodiscard]] auto select_mods(const btu::Path &mods_directory,
+                               btu::modmanager::ModManager manager,
+                               std::span<const std::u8string> blacklist) -> ModSelection;
+} // namespace cao
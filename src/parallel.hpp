@@ -0,0 +1,100 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "executor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stop_token>
+
+namespace cao {
+/// @brief Calls `func` on every element of `items`, using at most `max_concurrency` threads of `lane`.
+/// The calling thread takes part in the work. Elements that have not been started when a stop is
+/// requested are skipped. The first exception thrown by `func` is rethrown once all threads are done.
+///
+/// Helpers still queued in the executor when the work is done do nothing, so this can be called from a task
+/// of the same lane without waiting for threads that are all busy.
+template<typename T, typename Func>
+void parallel_for_each(Executor &executor,
+                       Lane lane,
+                       std::span<T> items,
+                       size_t max_concurrency,
+                       std::stop_token stop_token,
+                       Func func)
+{
+    struct SharedState
+    {
+        std::atomic_size_t next_index{0};
+
+        std::mutex mutex;
+        std::condition_variable helpers_done;
+        size_t active_helpers = 0;
+        bool closed           = false;
+        std::exception_ptr first_exception;
+    };
+
+    const auto state = std::make_shared<SharedState>();
+
+    const auto work = [&] {
+        while (!stop_token.stop_requested())
+        {
+            const auto index = state->next_index.fetch_add(1);
+            if (index >= items.size())
+                return;
+
+            try
+            {
+                func(items[index]);
+            }
+            catch (...)
+            {
+                const auto lock = std::scoped_lock(state->mutex);
+                if (!state->first_exception)
+                    state->first_exception = std::current_exception();
+            }
+        }
+    };
+
+    // The caller is one of the threads
+    const auto thread_count = std::clamp(max_concurrency, size_t{1}, std::max(items.size(), size_t{1}));
+    const auto helper_count = std::min(thread_count, executor.thread_count(lane) + 1) - 1;
+
+    for (size_t i = 0; i < helper_count; ++i)
+    {
+        // `work` refers to the caller's stack, it must not be used once the caller has returned
+        executor.submit(lane, [state, &work] {
+            {
+                const auto lock = std::scoped_lock(state->mutex);
+                if (state->closed)
+                    return;
+                ++state->active_helpers;
+            }
+
+            work();
+
+            {
+                const auto lock = std::scoped_lock(state->mutex);
+                --state->active_helpers;
+            }
+            state->helpers_done.notify_all();
+        });
+    }
+
+    work();
+
+    auto lock     = std::unique_lock(state->mutex);
+    state->closed = true;
+    state->helpers_done.wait(lock, [&] { return state->active_helpers == 0; });
+
+    if (state->first_exception)
+        std::rethrow_exception(state->first_exception);
+}
+} // namespace cao
@@ -0,0 +1,270 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "plugin_index.hpp"
+
+#include "parallel.hpp"
+
+#include <btu/common/string.hpp>
+#include <btu/esp/functions.hpp>
+#include <fmt/format.h>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace cao {
+/// @brief Identifies the current version of a plugin, or nothing if it cannot be read
+[[nodiscard]] auto stat_plugin(const std::filesystem::path &plugin_path) noexcept
+    -> std::optional<std::pair<uintmax_t, int64_t>>
+{
+    std::error_code ec;
+    const auto file_size = std::filesystem::file_size(plugin_path, ec);
+    if (ec)
+        return std::nullopt;
+
+    const auto write_time = std::filesystem::last_write_time(plugin_path, ec);
+    if (ec)
+        return std::nullopt;
+
+    return std::pair{file_size, static_cast<int64_t>(write_time.time_since_epoch().count())};
+}
+
+[[nodiscard]] auto index_key(const std::filesystem::path &plugin_path) -> std::string
+{
+    return btu::common::as_ascii_string(btu::common::to_lower(plugin_path.lexically_normal().u8string()));
+}
+
+/// @brief Lowercase, forward slashes, and without the `meshes/` or `textures/` prefix that plugins
+/// usually omit
+[[nodiscard]] auto normalize_asset_path(std::u8string_view path) -> std::u8string
+{
+    auto normalized = btu::common::to_lower(path);
+    std::ranges::replace(normalized, u8'\\', u8'/');
+
+    for (const auto prefix : {std::u8string_view(u8"meshes/"), std::u8string_view(u8"textures/")})
+    {
+        if (normalized.starts_with(prefix))
+        {
+            normalized.erase(0, prefix.size());
+            break;
+        }
+    }
+    return normalized;
+}
+
+PluginAssets::PluginAssets(const PluginInfo &info)
+{
+    headparts_.reserve(info.headparts.size());
+    for (const auto &headpart : info.headparts)
+        headparts_.emplace(normalize_asset_path(headpart), headpart);
+
+    landscape_textures_.reserve(info.landscape_textures.size());
+    for (const auto &texture : info.landscape_textures)
+        landscape_textures_.emplace(normalize_asset_path(texture), texture);
+}
+
+auto PluginAssets::apply(const std::filesystem::path &relative_path, const PerFileSettings &file_sets) const
+    -> std::optional<PerFileSettings>
+{
+    if (empty())
+        return std::nullopt;
+
+    const auto key = normalize_asset_path(relative_path.u8string());
+
+    const auto headpart = headparts_.find(key);
+    const auto texture  = landscape_textures_.find(key);
+    if (headpart == headparts_.end() && texture == landscape_textures_.end())
+        return std::nullopt;
+
+    // Only the matching entry is given to btu, so its own lookup stays trivial
+    auto result = file_sets;
+    if (headpart != headparts_.end())
+        result.nif.headpart_meshes.emplace_back(headpart->second);
+    if (texture != landscape_textures_.end())
+        result.tex.landscape_textures.emplace_back(texture->second);
+    return result;
+}
+
+PluginIndex::PluginIndex(std::filesystem::path file_path)
+    : file_path_(std::move(file_path))
+{
+    std::ifstream stream(file_path_, std::ios::binary);
+    if (!stream)
+        return;
+
+    try
+    {
+        const auto json = nlohmann::json::from_msgpack(std::istreambuf_iterator<char>(stream),
+                                                       std::istreambuf_iterator<char>());
+        entries_        = json.get<std::unordered_map<std::string, Entry>>();
+    }
+    catch (const std::exception &e)
+    {
+        PLOGW << "Ignoring unreadable plugin index " << file_path_.string() << ": " << e.what();
+        entries_.clear();
+    }
+}
+
+auto PluginIndex::find(const std::filesystem::path &plugin_path) const -> std::optional<PluginInfo>
+{
+    const auto stat = stat_plugin(plugin_path);
+    if (!stat)
+        return std::nullopt;
+
+    const auto lock = std::shared_lock(mutex_);
+
+    const auto it = entries_.find(index_key(plugin_path));
+    if (it == entries_.end() || it->second.file_size != stat->first || it->second.write_time != stat->second)
+        return std::nullopt;
+
+    return it->second.info;
+}
+
+void PluginIndex::insert(const std::filesystem::path &plugin_path, PluginInfo info)
+{
+    const auto stat = stat_plugin(plugin_path);
+    if (!stat)
+        return;
+
+    const auto lock = std::unique_lock(mutex_);
+    entries_.insert_or_assign(index_key(plugin_path),
+                              Entry{
+                                  .file_size  = stat->first,
+                                  .write_time = stat->second,
+                                  .info       = std::move(info),
+                              });
+    dirty_ = true;
+}
+
+auto PluginIndex::size() const noexcept -> size_t
+{
+    const auto lock = std::shared_lock(mutex_);
+    return entries_.size();
+}
+
+auto PluginIndex::save() -> bool
+{
+    const auto lock = std::unique_lock(mutex_);
+    if (!dirty_)
+        return true;
+
+    const auto bytes = nlohmann::json::to_msgpack(nlohmann::json(entries_));
+
+    // Write to a temporary file first, so a crash cannot leave a truncated index behind
+    auto temp_path = file_path_;
+    temp_path += ".tmp";
+    {
+        std::ofstream stream(temp_path, std::ios::binary | std::ios::trunc);
+        if (!stream)
+            return false;
+
+        stream.write(reinterpret_cast<const char *>(bytes.data()),
+                     static_cast<std::streamsize>(bytes.size()));
+        if (!stream)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, file_path_, ec);
+    dirty_ = static_cast<bool>(ec);
+    return !ec;
+}
+
+[[nodiscard]] auto list_plugins(const std::filesystem::path &mod_root) -> std::vector<std::filesystem::path>
+{
+    static constexpr auto k_plugin_exts = std::to_array<std::u8string_view>({u8".esp", u8".esm", u8".esl"});
+
+    auto plugins = std::vector<std::filesystem::path>{};
+
+    // The game only loads plugins from the root of the data directory
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(mod_root, ec))
+    {
+        const auto extension = btu::common::to_lower(entry.path().extension().u8string());
+        if (entry.is_regular_file(ec) && btu::common::contains(k_plugin_exts, extension))
+            plugins.emplace_back(entry.path());
+    }
+    return plugins;
+}
+
+[[nodiscard]] auto parse_plugin(const std::filesystem::path &plugin_path) -> PluginInfo
+{
+    PLOG_INFO << fmt::format("Parsing plugin {}", plugin_path.filename().string());
+
+    auto headparts          = btu::esp::list_headparts(plugin_path);
+    auto landscape_textures = btu::esp::list_landscape_textures(plugin_path);
+
+    if (!headparts && !landscape_textures)
+        PLOGV << fmt::format("Plugin {} has no headparts or landscape textures", plugin_path.string());
+
+    auto info = PluginInfo{};
+    if (headparts)
+        info.headparts = std::move(*headparts);
+    if (landscape_textures)
+        info.landscape_textures = std::move(*landscape_textures);
+    return info;
+}
+
+auto scan_plugins(const std::filesystem::path &mod_root,
+                  PluginIndex *index,
+                  Executor &executor,
+                  std::stop_token stop_token) -> PluginInfo
+{
+    struct Task
+    {
+        std::filesystem::path plugin_path;
+        std::optional<PluginInfo> info;
+        bool from_index = false;
+    };
+
+    auto tasks = std::vector<Task>{};
+    for (auto &plugin_path : list_plugins(mod_root))
+    {
+        auto info             = index != nullptr ? index->find(plugin_path) : std::nullopt;
+        const bool from_index = info.has_value();
+        tasks.emplace_back(Task{
+            .plugin_path = std::move(plugin_path),
+            .info        = std::move(info),
+            .from_index  = from_index,
+        });
+    }
+
+    const auto cached = std::ranges::count_if(tasks, &Task::from_index);
+    PLOGI << fmt::format("Found {} plugins in {}, {} of them unchanged since they were last parsed",
+                         tasks.size(),
+                         mod_root.string(),
+                         cached);
+
+    // Each task owns its result, so no lock is needed while parsing
+    const auto concurrency = executor.thread_count(Lane::Cpu);
+    parallel_for_each(executor, Lane::Cpu, std::span(tasks), concurrency, stop_token, [](Task &task) {
+        if (!task.info)
+            task.info = parse_plugin(task.plugin_path);
+    });
+
+    auto result = PluginInfo{};
+    for (auto &task : tasks)
+    {
+        if (!task.info)
+            continue; // stopped before the plugin was parsed
+
+        if (index != nullptr && !task.from_index)
+            index->insert(task.plugin_path, *task.info);
+
+        result.headparts.insert(result.headparts.end(),
+                                std::make_move_iterator(task.info->headparts.begin()),
+                                std::make_move_iterator(task.info->headparts.end()));
+        result.landscape_textures.insert(result.landscape_textures.end(),
+                                         std::make_move_iterator(task.info->landscape_textures.begin()),
+                                         std::make_move_iterator(task.info->landscape_textures.end()));
+    }
+
+    btu::common::remove_duplicates(result.headparts);
+    btu::common::remove_duplicates(result.landscape_textures);
+    return result;
+}
+} // namespace cao
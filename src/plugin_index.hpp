@@ -0,0 +1,97 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "executor.hpp"
+#include "settings/per_file_settings.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <shared_mutex>
+#include <stop_token>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cao {
+/// @brief Records of a plugin that change how assets are optimized
+struct PluginInfo
+{
+    std::vector<std::u8string> headparts;
+    std::vector<std::u8string> landscape_textures;
+};
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PluginInfo, headparts, landscape_textures)
+
+/// @brief Assets referenced by the plugins of a mod, indexed by normalized path.
+/// Built once per mod and shared by all the files of the mod.
+class PluginAssets
+{
+public:
+    explicit PluginAssets(const PluginInfo &info);
+
+    /// @brief Adds the plugin records matching `relative_path` to a copy of `file_sets`.
+    /// @return Nothing if no plugin references the file, which is the common case
+    [[nodiscard]] auto apply(const std::filesystem::path &relative_path,
+                             const PerFileSettings &file_sets) const -> std::optional<PerFileSettings>;
+
+    [[nodiscard]] auto empty() const noexcept -> bool
+    {
+        return headparts_.empty() && landscape_textures_.empty();
+    }
+
+private:
+    /// Normalized path -> path as written in the plugin
+    using Lookup = std::unordered_map<std::u8string, std::u8string>;
+
+    Lookup headparts_;
+    Lookup landscape_textures_;
+};
+
+/// @brief Persistent results of plugin parsing.
+/// An entry is only used while the size and modification time of the plugin are the ones it was parsed with.
+class PluginIndex
+{
+public:
+    /// @brief Loads the index stored at `file_path`. A missing or unreadable file gives an empty index.
+    explicit PluginIndex(std::filesystem::path file_path);
+
+    [[nodiscard]] auto find(const std::filesystem::path &plugin_path) const -> std::optional<PluginInfo>;
+    void insert(const std::filesystem::path &plugin_path, PluginInfo info);
+
+    /// @brief Writes the index to disk if it changed since it was loaded or last saved
+    [[nodiscard]] auto save() -> bool;
+
+    [[nodiscard]] auto size() const noexcept -> size_t;
+
+    static constexpr auto k_file_name = "plugin_index.msgpack";
+
+    struct Entry
+    {
+        uintmax_t file_size = 0;
+        int64_t write_time  = 0;
+        PluginInfo info;
+    };
+
+private:
+    std::filesystem::path file_path_;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    bool dirty_ = false;
+};
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PluginIndex::Entry, file_size, write_time, info)
+
+/// @brief Parses the plugins at the root of a mod, several at once.
+/// Plugins found in `index` are not parsed again, and newly parsed ones are added to it.
+/// @param index Can be null
+[[nodiscard]] auto scan_plugins(const std::filesystem::path &mod_root,
+                                PluginIndex *index,
+                                Executor &executor,
+                                std::stop_token stop_token) -> PluginInfo;
+} // namespace cao
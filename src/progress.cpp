@@ -0,0 +1,118 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "progress.hpp"
+
+#include <condition_variable>
+
+namespace cao {
+ProgressTracker::ProgressTracker(std::chrono::milliseconds interval, Publisher publish)
+    : publish_(std::move(publish))
+    , publisher_([this, interval](std::stop_token stop_token) {
+        auto mutex = std::mutex{};
+        auto wake  = std::condition_variable_any{};
+
+        // Only used to sleep until the next interval or the stop request, whichever comes first
+        auto lock = std::unique_lock(mutex);
+        const auto stopped = [&stop_token] { return stop_token.stop_requested(); };
+        while (!wake.wait_for(lock, stop_token, interval, stopped))
+            publish(false);
+
+        publish(true);
+    })
+{
+}
+
+ProgressTracker::~ProgressTracker()
+{
+    publisher_.request_stop();
+    publisher_.join();
+}
+
+auto ProgressTracker::current_slot() noexcept -> Slot &
+{
+    static std::atomic_size_t next_thread_index{0};
+    thread_local const size_t thread_index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+
+    return slots_[thread_index % k_slot_count];
+}
+
+void ProgressTracker::add_total(size_t count) noexcept
+{
+    files_total_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ProgressTracker::file_done(const btu::Path &path, uint64_t bytes)
+{
+    auto &slot = current_slot();
+    slot.files.fetch_add(1, std::memory_order_relaxed);
+    slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    // The path is only shown to the user, there is no need to copy it for every file
+    constexpr auto k_path_refresh = std::chrono::milliseconds(100);
+
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    if (now - slot.last_path_time.load(std::memory_order_relaxed)
+        < std::chrono::steady_clock::duration(k_path_refresh).count())
+        return;
+
+    slot.last_path_time.store(now, std::memory_order_relaxed);
+    const auto lock = std::scoped_lock(slot.path_mutex);
+    slot.last_path  = path;
+}
+
+void ProgressTracker::set_current(const btu::Path &path)
+{
+    auto &slot = current_slot();
+    slot.last_path_time.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                              std::memory_order_relaxed);
+
+    const auto lock = std::scoped_lock(slot.path_mutex);
+    slot.last_path  = path;
+}
+
+void ProgressTracker::publish(bool force)
+{
+    auto status = ProgressStatus{.files_total = files_total_.load(std::memory_order_relaxed)};
+
+    std::chrono::steady_clock::rep latest_path_time = -1;
+    for (auto &slot : slots_)
+    {
+        status.files_done += slot.files.load(std::memory_order_relaxed);
+        status.bytes_done += slot.bytes.load(std::memory_order_relaxed);
+
+        const auto path_time = slot.last_path_time.load(std::memory_order_relaxed);
+        if (path_time > latest_path_time)
+        {
+            latest_path_time = path_time;
+
+            const auto lock  = std::scoped_lock(slot.path_mutex);
+            status.last_path = slot.last_path;
+        }
+    }
+
+    const bool changed = status.files_done != files_published_ || status.files_total != total_published_
+                         || latest_path_time != path_time_published_;
+    if (!force && !changed)
+        return;
+
+    total_published_        = status.files_total;
+    path_time_published_    = latest_path_time;
+    status.files_since_last = status.files_done - files_published_;
+    files_published_        = status.files_done;
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    if (elapsed > 0)
+        status.files_per_second = static_cast<double>(status.files_done) / elapsed;
+
+    if (status.files_per_second > 0 && status.files_total >= status.files_done)
+    {
+        const auto remaining = static_cast<double>(status.files_total - status.files_done);
+        status.eta = std::chrono::seconds(static_cast<int64_t>(remaining / status.files_per_second));
+    }
+
+    publish_(status);
+}
+} // namespace cao
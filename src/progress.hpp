@@ -0,0 +1,86 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <btu/common/path.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace cao {
+struct ProgressStatus
+{
+    size_t files_total = 0;
+    size_t files_done  = 0;
+    /// Files done since the previous status
+    size_t files_since_last = 0;
+    uint64_t bytes_done     = 0;
+    double files_per_second = 0;
+    /// Nothing until the rate is known
+    std::optional<std::chrono::seconds> eta;
+    btu::Path last_path;
+};
+
+/// @brief Counts the files processed by many threads, and publishes the totals at a fixed interval.
+/// Each thread updates its own cache line, so workers never contend with each other or with the publisher.
+class ProgressTracker
+{
+public:
+    using Publisher = std::function<void(const ProgressStatus &)>;
+
+    /// @param publish Called from a thread owned by the tracker
+    ProgressTracker(std::chrono::milliseconds interval, Publisher publish);
+
+    ProgressTracker(const ProgressTracker &)                     = delete;
+    auto operator=(const ProgressTracker &) -> ProgressTracker & = delete;
+
+    ProgressTracker(ProgressTracker &&)                     = delete;
+    auto operator=(ProgressTracker &&) -> ProgressTracker & = delete;
+
+    /// @brief Stops publishing, after a last status with the final totals
+    ~ProgressTracker();
+
+    void add_total(size_t count) noexcept;
+    void file_done(const btu::Path &path, uint64_t bytes);
+    /// @brief Shows what is being worked on, without counting a file
+    void set_current(const btu::Path &path);
+
+private:
+    static constexpr size_t k_cache_line_size = 64;
+    static constexpr size_t k_slot_count      = 64;
+
+    struct alignas(k_cache_line_size) Slot
+    {
+        std::atomic_uint64_t files{0};
+        std::atomic_uint64_t bytes{0};
+
+        /// Only contended if more than `k_slot_count` threads report progress
+        std::mutex path_mutex;
+        btu::Path last_path;
+        std::atomic<std::chrono::steady_clock::rep> last_path_time{0};
+    };
+
+    [[nodiscard]] auto current_slot() noexcept -> Slot &;
+    /// @param force Publish even if nothing changed since the previous status
+    void publish(bool force);
+
+    std::array<Slot, k_slot_count> slots_;
+    std::atomic_size_t files_total_{0};
+
+    Publisher publish_;
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+    uint64_t files_published_                           = 0;
+    uint64_t total_published_                           = 0;
+    std::chrono::steady_clock::rep path_time_published_ = -1;
+
+    std::jthread publisher_;
+};
+} // namespace cao
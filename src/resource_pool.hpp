@@ -0,0 +1,110 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <btu/common/error.hpp>
+#include <tl/expected.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cao {
+/// @brief Bounded pool of expensive objects, created lazily and reused across threads.
+/// A thread acquiring an object gets exclusive access to it until its lease is destroyed.
+/// When all the objects are leased and the pool is full, `acquire` waits for one to be released.
+template<typename T>
+class ResourcePool
+{
+public:
+    using Factory = std::function<tl::expected<T, btu::common::Error>()>;
+
+    class Lease
+    {
+    public:
+        Lease(ResourcePool &pool, std::unique_ptr<T> resource)
+            : pool_(&pool)
+            , resource_(std::move(resource))
+        {
+        }
+
+        Lease(const Lease &)                     = delete;
+        auto operator=(const Lease &) -> Lease & = delete;
+
+        Lease(Lease &&) noexcept                     = default;
+        auto operator=(Lease &&) noexcept -> Lease & = default;
+
+        ~Lease()
+        {
+            if (resource_)
+                pool_->release(std::move(resource_));
+        }
+
+        [[nodiscard]] auto operator*() const noexcept -> T & { return *resource_; }
+        [[nodiscard]] auto operator->() const noexcept -> T * { return resource_.get(); }
+
+    private:
+        ResourcePool *pool_;
+        std::unique_ptr<T> resource_;
+    };
+
+    ResourcePool(Factory factory, size_t max_size)
+        : factory_(std::move(factory))
+        , max_size_(std::max(max_size, size_t{1}))
+    {
+    }
+
+    [[nodiscard]] auto acquire() -> tl::expected<Lease, btu::common::Error>
+    {
+        {
+            auto lock = std::unique_lock(mutex_);
+            cv_.wait(lock, [this] { return !idle_.empty() || created_ < max_size_; });
+
+            if (!idle_.empty())
+            {
+                auto resource = std::move(idle_.back());
+                idle_.pop_back();
+                return Lease(*this, std::move(resource));
+            }
+
+            ++created_;
+        }
+
+        // Created outside of the lock, creation can be slow
+        auto resource = factory_();
+        if (!resource)
+        {
+            {
+                const auto lock = std::scoped_lock(mutex_);
+                --created_;
+            }
+            cv_.notify_one();
+            return tl::make_unexpected(resource.error());
+        }
+
+        return Lease(*this, std::make_unique<T>(std::move(*resource)));
+    }
+
+private:
+    void release(std::unique_ptr<T> resource)
+    {
+        {
+            const auto lock = std::scoped_lock(mutex_);
+            idle_.emplace_back(std::move(resource));
+        }
+        cv_.notify_one();
+    }
+
+    Factory factory_;
+    size_t max_size_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<T>> idle_;
+    size_t created_ = 0;
+};
+} // namespace cao
@@ -0,0 +1,73 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "run_resources.hpp"
+
+#include <fmt/format.h>
+#include <plog/Log.h>
+
+#include <thread>
+
+namespace cao {
+/// @brief Creates a device on the selected adapter, or a default device if the adapter is not usable.
+/// The default device has no GPU: textures are compressed on the CPU, as on headless machines, so it is
+/// not considered an error
+[[nodiscard]] auto make_compression_device(uint32_t gpu_index)
+    -> tl::expected<btu::tex::CompressionDevice, btu::common::Error>
+{
+    if (auto device = btu::tex::CompressionDevice::make(gpu_index))
+        return std::move(*device);
+
+    PLOGW << fmt::format("Could not use GPU {} for texture compression. Compressing on the CPU", gpu_index);
+    return btu::tex::CompressionDevice();
+}
+
+auto worker_count() noexcept -> size_t
+{
+    return std::max(size_t{std::thread::hardware_concurrency()}, size_t{1});
+}
+
+[[nodiscard]] auto memory_budget_bytes(const Profile &profile) noexcept -> uint64_t
+{
+    constexpr uint64_t k_bytes_per_mb = 1024 * 1024;
+    if (profile.memory_budget_mb != 0)
+        return uint64_t{profile.memory_budget_mb} * k_bytes_per_mb;
+
+    return physical_memory().value_or(0) / 2;
+}
+
+[[nodiscard]] auto dedupe_store_bytes(const Profile &profile, uint64_t memory_budget) noexcept -> uint64_t
+{
+    constexpr uint64_t k_bytes_per_mb = 1024 * 1024;
+    if (profile.dedupe_memory_mb != 0)
+        return uint64_t{profile.dedupe_memory_mb} * k_bytes_per_mb;
+
+    return memory_budget / 4;
+}
+
+[[nodiscard]] auto cpu_thread_count(const Profile &profile) noexcept -> size_t
+{
+    return profile.cpu_threads != 0 ? profile.cpu_threads : worker_count();
+}
+
+[[nodiscard]] auto io_thread_count(const Profile &profile) noexcept -> size_t
+{
+    constexpr size_t k_default_io_threads = 4;
+    return profile.io_threads != 0 ? profile.io_threads : k_default_io_threads;
+}
+
+RunResources::RunResources(const Profile &profile)
+    : compression_devices([gpu_index = profile.gpu_index] { return make_compression_device(gpu_index); },
+                          cpu_thread_count(profile))
+    , texture_encoder(profile.texture_encoder)
+    , anim_exes(
+          [directory = profile.animation_converter_directory] { return btu::hkx::AnimExe::make(directory); },
+          cpu_thread_count(profile))
+    , memory_budget(memory_budget_bytes(profile))
+    , dedupe_store(dedupe_store_bytes(profile, memory_budget.limit()))
+    , executor(cpu_thread_count(profile), io_thread_count(profile))
+{
+}
+} // namespace cao
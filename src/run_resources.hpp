@@ -0,0 +1,39 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "dedupe_store.hpp"
+#include "executor.hpp"
+#include "memory_budget.hpp"
+#include "resource_pool.hpp"
+#include "settings/profile.hpp"
+#include "statistics.hpp"
+
+#include <btu/hkx/anim.hpp>
+#include <btu/tex/compression_device.hpp>
+
+namespace cao {
+/// @brief Number of threads worth running for CPU bound work
+[[nodiscard]] auto worker_count() noexcept -> size_t;
+
+/// @brief Objects that are expensive to create and shared by all the files processed during a run
+class RunResources
+{
+public:
+    explicit RunResources(const Profile &profile);
+
+    ResourcePool<btu::tex::CompressionDevice> compression_devices;
+    TextureEncoder texture_encoder;
+    ResourcePool<btu::hkx::AnimExe> anim_exes;
+
+    MemoryBudget memory_budget;
+    DedupeStore dedupe_store;
+
+    RunStatistics statistics;
+
+    /// Declared last, so its threads are joined before the other resources are destroyed
+    Executor executor;
+};
+} // namespace cao
@@ -22,6 +22,14 @@ enum class TextureResizingMode : std::uint8_t
     BySize
 };
 
+/// Effort spent on texture compression, traded against quality
+enum class CompressionTier : std::uint8_t
+{
+    Fast,
+    Balanced,
+    Max,
+};
+
 enum class GuiMode : std::uint8_t
 {
     QuickOptimize,
@@ -44,6 +52,11 @@ NLOHMANN_JSON_SERIALIZE_ENUM(cao::TextureResizingMode,
                               {cao::TextureResizingMode::ByRatio, "ByRatio"},
                               {cao::TextureResizingMode::BySize, "BySize"}})
 
+NLOHMANN_JSON_SERIALIZE_ENUM(cao::CompressionTier,
+                             {{cao::CompressionTier::Fast, "Fast"},
+                              {cao::CompressionTier::Balanced, "Balanced"},
+                              {cao::CompressionTier::Max, "Max"}})
+
 NLOHMANN_JSON_SERIALIZE_ENUM(cao::GuiMode,
                              {{cao::GuiMode::QuickOptimize, "QuickOptimize"},
                               {cao::GuiMode::Medium, "Medium"},
@@ -55,5 +68,6 @@ NLOHMANN_JSON_SERIALIZE_ENUM(cao::GuiTheme, {{cao::GuiTheme::Dark, "Dark"}, {cao
 
 Q_DECLARE_METATYPE(cao::OptimizationMode)
 Q_DECLARE_METATYPE(cao::TextureResizingMode)
+Q_DECLARE_METATYPE(cao::CompressionTier)
 Q_DECLARE_METATYPE(cao::GuiMode)
 Q_DECLARE_METATYPE(cao::GuiTheme)
@@ -4,11 +4,14 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 #pragma once
 
+#include "base_types.hpp"
+
 #include <btu/common/path.hpp>
 #include <btu/hkx/anim.hpp>
 #include <btu/nif/optimize.hpp>
 #include <btu/tex/optimize.hpp>
 
+#include <algorithm>
 #include <optional>
 #include <regex>
 
@@ -28,6 +31,12 @@ public:
         Regex,
     };
 
+    /// @brief A pattern matching every path
+    Pattern()
+        : Pattern(u8"*")
+    {
+    }
+
     explicit Pattern(std::u8string pattern, const Type type = Type::Wildcard)
     {
         switch (type)
@@ -47,13 +56,23 @@ public:
         }
     }
 
-    [[nodiscard]] auto matches(const std::filesystem::path &path) const noexcept -> bool
+    /// @brief Converts a path to the form expected by `matches_canonical`
+    [[nodiscard]] static auto canonize(const std::filesystem::path &path) -> std::u8string
     {
-        assert(!pattern_.valueless_by_exception());
-
         constexpr auto canonize_path = btu::common::make_path_canonizer(u8"");
+        return canonize_path(path);
+    }
+
+    [[nodiscard]] auto matches(const std::filesystem::path &path) const noexcept -> bool
+    {
+        return matches_canonical(canonize(path));
+    }
 
-        auto str = canonize_path(BTU_MOV(path));
+    /// @brief Same as `matches`, for a path that was already canonized. Avoids canonizing the same path
+    /// once per pattern
+    [[nodiscard]] auto matches_canonical(const std::u8string &str) const noexcept -> bool
+    {
+        assert(!pattern_.valueless_by_exception());
 
         const auto visitor = btu::common::Overload{
             [&str](const std::u8string &pattern) { return btu::common::str_match(str, pattern); },
@@ -65,6 +84,42 @@ public:
         return std::visit(visitor, pattern_);
     }
 
+    /// @brief Lowercase extension, without the dot, that every path matched by this pattern has.
+    /// @return std::nullopt if the pattern can match several extensions
+    [[nodiscard]] auto extension() const -> std::optional<std::u8string>
+    {
+        const auto text = this->text();
+
+        const auto is_ext_char = [](char8_t c) {
+            return (c >= u8'a' && c <= u8'z') || (c >= u8'A' && c <= u8'Z') || (c >= u8'0' && c <= u8'9')
+                   || c == u8'_' || c == u8'-';
+        };
+
+        const auto dot = text.rfind(u8'.');
+        if (dot == std::u8string::npos || dot + 1 == text.size())
+            return std::nullopt;
+
+        auto ext = text.substr(dot + 1);
+        if (!std::ranges::all_of(ext, is_ext_char))
+            return std::nullopt;
+
+        if (type() == Type::Regex)
+        {
+            // Only handle regexes ending with an escaped dot and a literal, without any alternative
+            size_t backslashes = 0;
+            for (auto i = dot; i > 0 && text[i - 1] == u8'\\'; --i)
+                ++backslashes;
+
+            if (backslashes % 2 == 0 || text.find(u8'|') != std::u8string::npos)
+                return std::nullopt;
+        }
+
+        std::ranges::transform(ext, ext.begin(), [](char8_t c) {
+            return (c >= u8'A' && c <= u8'Z') ? static_cast<char8_t>(c - u8'A' + u8'a') : c;
+        });
+        return ext;
+    }
+
     [[nodiscard]] auto text() const noexcept -> std::u8string
     {
         assert(!pattern_.valueless_by_exception());
@@ -116,6 +171,8 @@ struct PerFileSettings
 
     OptimizeType tex_optimize = OptimizeType::Normal;
     btu::tex::Settings tex    = btu::tex::Settings::get(btu::Game::SSE);
+    /// Only used by the CPU texture encoder, the compression device has a fixed effort
+    CompressionTier tex_compression_tier = CompressionTier::Balanced;
 
     OptimizeType nif_optimize = OptimizeType::Normal;
     btu::nif::Settings nif    = btu::nif::Settings::get(btu::Game::SSE);
@@ -144,7 +201,16 @@ struct PerFileSettings
     }
 };
 
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(
-    PerFileSettings, pack, tex_optimize, tex, nif_optimize, nif, hkx_optimize, hkx_target, pattern)
+// Patterns saved by older versions lack the newer fields
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(PerFileSettings,
+                                                pack,
+                                                tex_optimize,
+                                                tex,
+                                                tex_compression_tier,
+                                                nif_optimize,
+                                                nif,
+                                                hkx_optimize,
+                                                hkx_target,
+                                                pattern)
 
 } // namespace cao
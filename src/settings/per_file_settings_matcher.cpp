@@ -0,0 +1,82 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "per_file_settings_matcher.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace cao {
+PerFileSettingsMatcher::PerFileSettingsMatcher(std::vector<const PerFileSettings *> settings)
+    : settings_(std::move(settings))
+{
+    assert(!settings_.empty() && "PerFileSettingsMatcher: the base settings are required");
+
+    // The last settings are the fallback and never need to be tested
+    for (size_t i = 0; i + 1 < settings_.size(); ++i)
+    {
+        if (auto ext = settings_[i]->pattern.extension())
+            by_extension_[std::move(*ext)].emplace_back(i);
+        else
+            any_extension_.emplace_back(i);
+    }
+
+    // Merge the generic patterns into each list, keeping the priority order
+    for (auto &[ext, indexes] : by_extension_)
+    {
+        auto merged = std::vector<size_t>{};
+        merged.reserve(indexes.size() + any_extension_.size());
+        std::ranges::merge(indexes, any_extension_, std::back_inserter(merged));
+        indexes = std::move(merged);
+    }
+}
+
+[[nodiscard]] auto canonical_extension(const std::u8string &canonical_path) -> std::u8string
+{
+    const auto dot = canonical_path.rfind(u8'.');
+    if (dot == std::u8string::npos)
+        return {};
+
+    const auto slash = canonical_path.rfind(u8'/');
+    if (slash != std::u8string::npos && slash > dot)
+        return {};
+
+    auto ext = canonical_path.substr(dot + 1);
+    std::ranges::transform(ext, ext.begin(), [](char8_t c) {
+        return (c >= u8'A' && c <= u8'Z') ? static_cast<char8_t>(c - u8'A' + u8'a') : c;
+    });
+    return ext;
+}
+
+auto PerFileSettingsMatcher::find_index(const std::filesystem::path &path) const -> size_t
+{
+    const auto canonical = Pattern::canonize(path);
+
+    const auto it          = by_extension_.find(canonical_extension(canonical));
+    const auto &candidates = it == by_extension_.end() ? any_extension_ : it->second;
+
+    const auto match = std::ranges::find_if(candidates, [this, &canonical](size_t index) {
+        return settings_[index]->pattern.matches_canonical(canonical);
+    });
+
+    return match == candidates.end() ? settings_.size() - 1 : *match;
+}
+
+auto PerFileSettingsMatcher::find(const std::filesystem::path &path) const -> const PerFileSettings &
+{
+    return *settings_[find_index(path)];
+}
+
+auto PerFileSettingsMatcher::at(size_t index) const -> const PerFileSettings &
+{
+    return *settings_.at(index);
+}
+
+auto PerFileSettingsMatcher::size() const noexcept -> size_t
+{
+    return settings_.size();
+}
+} // namespace cao
@@ -0,0 +1,37 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "per_file_settings.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace cao {
+/// @brief Finds the PerFileSettings matching a path, without trying every pattern.
+/// Built once per run from `Profile::per_file_settings()`. Patterns are indexed by the extension they
+/// require, so a path is only tested against the patterns that can match its extension, in priority order.
+/// @note Holds pointers to the settings it was built from, which must outlive it
+class PerFileSettingsMatcher
+{
+public:
+    /// @param settings Settings ordered by priority. The last one is used when no other matches
+    explicit PerFileSettingsMatcher(std::vector<const PerFileSettings *> settings);
+
+    [[nodiscard]] auto find_index(const std::filesystem::path &path) const -> size_t;
+    [[nodiscard]] auto find(const std::filesystem::path &path) const -> const PerFileSettings &;
+
+    [[nodiscard]] auto at(size_t index) const -> const PerFileSettings &;
+    [[nodiscard]] auto size() const noexcept -> size_t;
+
+private:
+    std::vector<const PerFileSettings *> settings_;
+
+    /// Indexes of the patterns to test for a given extension, including the ones matching any extension
+    std::unordered_map<std::u8string, std::vector<size_t>> by_extension_;
+    /// Indexes of the patterns matching any extension
+    std::vector<size_t> any_extension_;
+};
+} // namespace cao
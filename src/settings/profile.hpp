@@ -19,6 +19,14 @@ enum class BsaOperation : std::uint8_t
     Extract,
 };
 
+enum class TextureEncoder : std::uint8_t
+{
+    /// The compression device, on the selected GPU if there is one
+    Device,
+    /// bc7enc and rgbcx, on all the CPU threads. Formats other than BC1 and BC7 still use the device
+    Cpu,
+};
+
 class Profile
 {
 public:
@@ -28,16 +36,51 @@ public:
     bool bsa_allow_compression  = true;
     bool bsa_make_overrides     = false;
 
+    /// Read back the whole index of written archives instead of only checking their header
+    bool bsa_full_verification = false;
+
     // TODO: think about removing this and letting the UI handle it
     bool dry_run = false;
 
     uint32_t gpu_index{0};
+    TextureEncoder texture_encoder = TextureEncoder::Device;
+
+    /// Skip files that were already optimized with the same settings during a previous run
+    bool use_file_cache = true;
+
+    /// Process files found identical in several mods once, and reuse the result for the others
+    bool dedupe_files = true;
+
+    /// Memory kept for the results of deduplicated files, in MB. 0 means a quarter of the memory budget
+    uint32_t dedupe_memory_mb{0};
+
+    /// In several mods mode, skip files hidden by a mod with a higher priority. Only used with MO2,
+    /// and not when creating archives
+    bool skip_overridden_files = true;
+
+    /// Number of mods processed at the same time in several mods mode. 0 means automatic.
+    uint32_t max_concurrent_mods{0};
+
+    /// Number of archives extracted at the same time. 0 means automatic, depending on the drive type
+    uint32_t max_concurrent_archives{0};
+
+    /// Threads used for computations, such as texture compression. 0 means one per hardware thread
+    uint32_t cpu_threads{0};
+
+    /// Threads used for disk heavy work, such as archive extraction and writing. 0 means automatic
+    uint32_t io_threads{0};
+
+    /// Memory that files being processed at the same time may use, in MB. 0 means half of the physical memory
+    uint32_t memory_budget_mb{0};
 
     OptimizationMode optimization_mode = OptimizationMode::SingleMod;
     btu::Game target_game              = btu::Game::SSE;
 
     btu::Path input_path;
 
+    /// Directory containing the animation converter and the files it needs
+    btu::Path animation_converter_directory = "data";
+
     std::vector<std::u8string> mods_blacklist;
 
     [[nodiscard]] auto per_file_settings() noexcept -> std::vector<PerFileSettings *>
@@ -100,8 +143,9 @@ public:
         per_file_settings_.insert(per_file_settings_.begin() + target, std::move(pfs));
     }
 
+    /// @brief Finds the settings matching `path`. When looking up many files, prefer PerFileSettingsMatcher
     [[nodiscard]] auto get_per_file_settings(const std::filesystem::path &path) const noexcept
-        -> PerFileSettings
+        -> const PerFileSettings &
     {
         const auto it = std::ranges::find_if(per_file_settings_, [&path](const auto &settings) {
             return settings.matches(path);
@@ -122,19 +166,31 @@ private:
     [[nodiscard]] static auto set_fnv_settings(Profile profile) noexcept -> Profile;
 
 public:
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Profile,
-                                   bsa_operation,
-                                   bsa_make_dummy_plugins,
-                                   bsa_allow_compression,
-                                   bsa_make_overrides,
-                                   dry_run,
-                                   gpu_index,
-                                   optimization_mode,
-                                   target_game,
-                                   input_path,
-                                   mods_blacklist,
-                                   base_per_file_settings_,
-                                   per_file_settings_)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Profile,
+                                                bsa_operation,
+                                                bsa_make_dummy_plugins,
+                                                bsa_allow_compression,
+                                                bsa_make_overrides,
+                                                bsa_full_verification,
+                                                dry_run,
+                                                gpu_index,
+                                                texture_encoder,
+                                                use_file_cache,
+                                                dedupe_files,
+                                                dedupe_memory_mb,
+                                                skip_overridden_files,
+                                                max_concurrent_mods,
+                                                max_concurrent_archives,
+                                                cpu_threads,
+                                                io_threads,
+                                                memory_budget_mb,
+                                                optimization_mode,
+                                                target_game,
+                                                input_path,
+                                                animation_converter_directory,
+                                                mods_blacklist,
+                                                base_per_file_settings_,
+                                                per_file_settings_)
 };
 
 NLOHMANN_JSON_SERIALIZE_ENUM(BsaOperation,
@@ -142,4 +198,7 @@ NLOHMANN_JSON_SERIALIZE_ENUM(BsaOperation,
                               {BsaOperation::Create, "create"},
                               {BsaOperation::Extract, "extract"}})
 
+NLOHMANN_JSON_SERIALIZE_ENUM(TextureEncoder,
+                             {{TextureEncoder::Device, "device"}, {TextureEncoder::Cpu, "cpu"}})
+
 } // namespace cao
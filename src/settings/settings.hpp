@@ -23,6 +23,15 @@ struct GuiSettings
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(
     GuiSettings, gui_theme, remember_gui_mode, gui_mode, first_run, selected_pattern)
 
+struct LogSettings
+{
+    /// The log file is rolled over once it reaches this size
+    size_t file_size_mb = 16;
+    size_t kept_files   = 20;
+};
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(LogSettings, file_size_mb, kept_files)
+
 class Settings
 {
 public:
@@ -49,13 +58,16 @@ public:
 
     // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
     GuiSettings gui{};
+    // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+    LogSettings log{};
 
 private:
     std::vector<std::pair<std::u8string, Profile>> profiles_;
     size_t current_profile_index_ = 0;
 
 public:
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Settings, gui, profiles_, current_profile_index_)
+    // Settings saved by older versions lack the newer fields
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Settings, gui, log, profiles_, current_profile_index_)
 };
 
 [[nodiscard]] auto current_per_file_settings(Settings &sets) -> PerFileSettings &;
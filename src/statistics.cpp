@@ -0,0 +1,185 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "statistics.hpp"
+
+#include <fmt/format.h>
+#include <plog/Log.h>
+
+#include <bit>
+#include <fstream>
+
+namespace cao {
+auto to_string(Stage stage) noexcept -> std::string_view
+{
+    switch (stage)
+    {
+        case Stage::PluginParsing: return "plugin_parsing";
+        case Stage::ArchiveExtraction: return "archive_extraction";
+        case Stage::MeshLoad: return "mesh_load";
+        case Stage::MeshComputeSteps: return "mesh_compute_steps";
+        case Stage::MeshOptimize: return "mesh_optimize";
+        case Stage::MeshSave: return "mesh_save";
+        case Stage::TextureLoad: return "texture_load";
+        case Stage::TextureComputeSteps: return "texture_compute_steps";
+        case Stage::TextureOptimize: return "texture_optimize";
+        case Stage::TextureSave: return "texture_save";
+        case Stage::AnimationConvert: return "animation_convert";
+        case Stage::ArchiveBuilding: return "archive_building";
+        case Stage::ArchiveWriting: return "archive_writing";
+        case Stage::ArchiveVerification: return "archive_verification";
+    }
+    return "unknown";
+}
+
+void RunStatistics::record(Stage stage,
+                           std::chrono::nanoseconds duration,
+                           uint64_t bytes_in,
+                           uint64_t bytes_out) noexcept
+{
+    auto &counters = counters_[static_cast<size_t>(stage)];
+    const auto ns  = static_cast<uint64_t>(std::max(duration.count(), std::chrono::nanoseconds::rep{0}));
+
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    counters.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    counters.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+    counters.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+
+    auto max = counters.max_ns.load(std::memory_order_relaxed);
+    while (ns > max && !counters.max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+
+    const auto us     = ns / 1000;
+    const auto bucket = std::min(static_cast<size_t>(std::bit_width(us)), k_histogram_buckets - 1);
+    counters.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void RunStatistics::record_duplicate(uint64_t bytes) noexcept
+{
+    duplicates_.record(bytes);
+}
+
+void RunStatistics::record_overridden(uint64_t bytes) noexcept
+{
+    overridden_.record(bytes);
+}
+
+RunStatistics::Timer::Timer(RunStatistics &stats, Stage stage, uint64_t bytes_in) noexcept
+    : stats_(stats)
+    , stage_(stage)
+    , bytes_in_(bytes_in)
+    , start_(std::chrono::steady_clock::now())
+{
+}
+
+RunStatistics::Timer::~Timer()
+{
+    stats_.record(stage_, std::chrono::steady_clock::now() - start_, bytes_in_, bytes_out_);
+}
+
+auto RunStatistics::to_json(std::chrono::nanoseconds wall_time) const -> nlohmann::json
+{
+    constexpr double k_ns_per_second = 1e9;
+    constexpr double k_bytes_per_mb  = 1024.0 * 1024.0;
+
+    auto stages = nlohmann::json::object();
+    for (size_t i = 0; i < k_stage_count; ++i)
+    {
+        const auto &counters = counters_[i];
+        const auto count     = counters.count.load();
+        if (count == 0)
+            continue;
+
+        const auto seconds = static_cast<double>(counters.total_ns.load()) / k_ns_per_second;
+
+        // Percentiles are the upper bound of the bucket they fall in
+        const auto percentile_ms = [&](double fraction) {
+            const auto target = static_cast<uint64_t>(fraction * static_cast<double>(count));
+            uint64_t seen     = 0;
+            for (size_t bucket = 0; bucket < k_histogram_buckets; ++bucket)
+            {
+                seen += counters.histogram[bucket].load();
+                if (seen > target)
+                    return static_cast<double>(uint64_t{1} << bucket) / 1000.0;
+            }
+            return static_cast<double>(counters.max_ns.load()) / 1e6;
+        };
+
+        auto histogram = nlohmann::json::array();
+        for (const auto &bucket : counters.histogram)
+            histogram.push_back(bucket.load());
+        while (!histogram.empty() && histogram.back() == 0)
+            histogram.erase(histogram.end() - 1);
+
+        const auto bytes_in = counters.bytes_in.load();
+        stages[std::string(to_string(static_cast<Stage>(i)))] = {
+            {"count", count},
+            {"total_s", seconds},
+            {"mean_ms", seconds * 1000.0 / static_cast<double>(count)},
+            {"max_ms", static_cast<double>(counters.max_ns.load()) / 1e6},
+            {"p50_ms", percentile_ms(0.50)},
+            {"p90_ms", percentile_ms(0.90)},
+            {"p99_ms", percentile_ms(0.99)},
+            {"bytes_in", bytes_in},
+            {"bytes_out", counters.bytes_out.load()},
+            {"items_per_s", seconds > 0 ? static_cast<double>(count) / seconds : 0.0},
+            {"mb_per_s", seconds > 0 ? static_cast<double>(bytes_in) / k_bytes_per_mb / seconds : 0.0},
+            {"histogram_log2_us", std::move(histogram)},
+        };
+    }
+
+    return {
+        {"wall_time_s", static_cast<double>(wall_time.count()) / k_ns_per_second},
+        {"stages", std::move(stages)},
+        {"duplicates", duplicates_.to_json()},
+        {"overridden", overridden_.to_json()},
+    };
+}
+
+auto RunStatistics::report(const std::filesystem::path &report_path, std::chrono::nanoseconds wall_time) const
+    -> bool
+{
+    const auto json = to_json(wall_time);
+
+    PLOGI << fmt::format("Run took {:.2f}s", json["wall_time_s"].get<double>());
+    for (const auto &[name, stage] : json["stages"].items())
+    {
+        PLOGI << fmt::format("{:<22} {:>7} items, {:>9.2f}s, mean {:>8.2f}ms, p99 {:>8.2f}ms, {:>8.2f} MB/s",
+                             name,
+                             stage["count"].get<uint64_t>(),
+                             stage["total_s"].get<double>(),
+                             stage["mean_ms"].get<double>(),
+                             stage["p99_ms"].get<double>(),
+                             stage["mb_per_s"].get<double>());
+    }
+
+    constexpr double k_bytes_per_mb = 1024.0 * 1024.0;
+    const auto skipped_mb           = [&json](const char *key) {
+        return static_cast<double>(json[key]["bytes"].get<uint64_t>()) / k_bytes_per_mb;
+    };
+
+    if (const auto duplicates = json["duplicates"]["count"].get<uint64_t>(); duplicates != 0)
+        PLOGI << fmt::format("{} files were identical to files already processed, saving {:.2f} MB of work",
+                             duplicates,
+                             skipped_mb("duplicates"));
+
+    if (const auto overridden = json["overridden"]["count"].get<uint64_t>(); overridden != 0)
+        PLOGI << fmt::format("{} files were skipped as other mods override them, saving {:.2f} MB of work",
+                             overridden,
+                             skipped_mb("overridden"));
+
+    std::error_code ec;
+    std::filesystem::create_directories(report_path.parent_path(), ec);
+
+    std::ofstream stream(report_path);
+    stream << json.dump(4);
+    if (!stream)
+    {
+        PLOGW << "Failed to write run report to " << report_path.string();
+        return false;
+    }
+    PLOGI << "Run report written to " << report_path.string();
+    return true;
+}
+} // namespace cao
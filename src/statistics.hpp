@@ -0,0 +1,124 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string_view>
+
+namespace cao {
+enum class Stage : std::uint8_t
+{
+    PluginParsing,
+    ArchiveExtraction,
+    MeshLoad,
+    MeshComputeSteps,
+    MeshOptimize,
+    MeshSave,
+    TextureLoad,
+    TextureComputeSteps,
+    TextureOptimize,
+    TextureSave,
+    AnimationConvert,
+    ArchiveBuilding,
+    ArchiveWriting,
+    ArchiveVerification,
+};
+
+constexpr size_t k_stage_count = static_cast<size_t>(Stage::ArchiveVerification) + 1;
+
+[[nodiscard]] auto to_string(Stage stage) noexcept -> std::string_view;
+
+/// @brief Time spent and bytes handled by each stage of a run. Can be updated from any thread.
+/// Durations are summed over all threads, so they are CPU time rather than wall time
+class RunStatistics
+{
+public:
+    void record(Stage stage,
+                std::chrono::nanoseconds duration,
+                uint64_t bytes_in,
+                uint64_t bytes_out) noexcept;
+
+    /// @brief Records the time elapsed between its creation and its destruction
+    class Timer
+    {
+    public:
+        Timer(RunStatistics &stats, Stage stage, uint64_t bytes_in) noexcept;
+
+        Timer(const Timer &)                     = delete;
+        auto operator=(const Timer &) -> Timer & = delete;
+
+        Timer(Timer &&)                     = delete;
+        auto operator=(Timer &&) -> Timer & = delete;
+
+        ~Timer();
+
+        void set_bytes_out(uint64_t bytes) noexcept { bytes_out_ = bytes; }
+
+    private:
+        RunStatistics &stats_;
+        Stage stage_;
+        uint64_t bytes_in_;
+        uint64_t bytes_out_ = 0;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /// @brief Counts a file that was not processed because an identical one was
+    void record_duplicate(uint64_t bytes) noexcept;
+
+    /// @brief Counts a file that was not processed because a mod with a higher priority overrides it
+    void record_overridden(uint64_t bytes) noexcept;
+
+    [[nodiscard]] auto time(Stage stage, uint64_t bytes_in = 0) noexcept -> Timer
+    {
+        return Timer(*this, stage, bytes_in);
+    }
+
+    [[nodiscard]] auto to_json(std::chrono::nanoseconds wall_time) const -> nlohmann::json;
+
+    /// @brief Logs one line per stage that was used, and writes the full report to `report_path`
+    auto report(const std::filesystem::path &report_path, std::chrono::nanoseconds wall_time) const -> bool;
+
+private:
+    /// Bucket `i` counts durations in [2^(i-1), 2^i) microseconds
+    static constexpr size_t k_histogram_buckets = 40;
+
+    struct Counters
+    {
+        std::atomic_uint64_t count;
+        std::atomic_uint64_t total_ns;
+        std::atomic_uint64_t max_ns;
+        std::atomic_uint64_t bytes_in;
+        std::atomic_uint64_t bytes_out;
+        std::array<std::atomic_uint64_t, k_histogram_buckets> histogram;
+    };
+
+    std::array<Counters, k_stage_count> counters_{};
+
+    struct SkippedFiles
+    {
+        std::atomic_uint64_t count;
+        std::atomic_uint64_t bytes;
+
+        void record(uint64_t size) noexcept
+        {
+            count.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] auto to_json() const -> nlohmann::json
+        {
+            return {{"count", count.load()}, {"bytes", bytes.load()}};
+        }
+    };
+
+    SkippedFiles duplicates_{};
+    SkippedFiles overridden_{};
+};
+} // namespace cao
@@ -0,0 +1,118 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "storage.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#endif
+
+namespace cao {
+#ifdef _WIN32
+auto detect_storage_kind(const std::filesystem::path &path) noexcept -> StorageKind
+{
+    std::wstring volume(MAX_PATH, L'\0');
+    if (GetVolumePathNameW(path.c_str(), volume.data(), static_cast<DWORD>(volume.size())) == 0)
+        return StorageKind::Unknown;
+
+    volume.resize(volume.find(L'\0'));
+    if (!volume.empty() && volume.back() == L'\\')
+        volume.pop_back();
+
+    const auto device_path = L"\\\\.\\" + volume;
+
+    HANDLE device = CreateFileW(device_path.c_str(),
+                                0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                nullptr,
+                                OPEN_EXISTING,
+                                0,
+                                nullptr);
+    if (device == INVALID_HANDLE_VALUE)
+        return StorageKind::Unknown;
+
+    auto query = STORAGE_PROPERTY_QUERY{.PropertyId = StorageDeviceSeekPenaltyProperty,
+                                        .QueryType  = PropertyStandardQuery};
+
+    auto descriptor = DEVICE_SEEK_PENALTY_DESCRIPTOR{};
+    DWORD bytes_returned{};
+
+    const bool success = DeviceIoControl(device,
+                                         IOCTL_STORAGE_QUERY_PROPERTY,
+                                         &query,
+                                         sizeof(query),
+                                         &descriptor,
+                                         sizeof(descriptor),
+                                         &bytes_returned,
+                                         nullptr)
+                         != 0;
+    CloseHandle(device);
+
+    if (!success)
+        return StorageKind::Unknown;
+
+    return descriptor.IncursSeekPenalty != 0 ? StorageKind::Rotational : StorageKind::SolidState;
+}
+#else
+[[nodiscard]] auto read_rotational_flag(const std::filesystem::path &queue_dir) noexcept -> StorageKind
+{
+    std::ifstream file(queue_dir / "rotational");
+    char flag{};
+    if (!(file >> flag))
+        return StorageKind::Unknown;
+
+    return flag == '1' ? StorageKind::Rotational : StorageKind::SolidState;
+}
+
+auto detect_storage_kind(const std::filesystem::path &path) noexcept -> StorageKind
+{
+    struct stat info
+    {
+    };
+    if (stat(path.c_str(), &info) != 0)
+        return StorageKind::Unknown;
+
+    const auto device_dir = std::filesystem::path("/sys/dev/block")
+                            / (std::to_string(major(info.st_dev)) + ":" + std::to_string(minor(info.st_dev)));
+
+    if (const auto kind = read_rotational_flag(device_dir / "queue"); kind != StorageKind::Unknown)
+        return kind;
+
+    // Partitions do not have a queue, their parent disk does
+    std::error_code ec;
+    const auto real_dir = std::filesystem::canonical(device_dir, ec);
+    if (ec)
+        return StorageKind::Unknown;
+
+    return read_rotational_flag(real_dir.parent_path() / "queue");
+}
+#endif
+
+auto io_concurrency(StorageKind kind) noexcept -> size_t
+{
+    constexpr size_t max_solid_state_tasks = 8;
+    constexpr size_t unknown_tasks         = 2;
+
+    switch (kind)
+    {
+        case StorageKind::Rotational: return 1;
+        case StorageKind::SolidState:
+            return std::clamp(size_t{std::thread::hardware_concurrency()}, size_t{1}, max_solid_state_tasks);
+        case StorageKind::Unknown: return unknown_tasks;
+    }
+    return 1;
+}
+} // namespace cao
@@ -0,0 +1,24 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace cao {
+enum class StorageKind : std::uint8_t
+{
+    Unknown,
+    Rotational,
+    SolidState,
+};
+
+/// @brief Finds out whether the drive holding `path` is a spinning disk
+[[nodiscard]] auto detect_storage_kind(const std::filesystem::path &path) noexcept -> StorageKind;
+
+/// @brief Number of I/O heavy tasks worth running at once on a drive.
+/// Spinning disks are slowed down by concurrent accesses, solid state drives need them to be saturated
+[[nodiscard]] auto io_concurrency(StorageKind kind) noexcept -> size_t;
+} // namespace cao
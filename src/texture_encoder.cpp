@@ -0,0 +1,184 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "texture_encoder.hpp"
+
+#include "parallel.hpp"
+
+#include <bc7enc.h>
+#include <rgbcx.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <system_error>
+#include <vector>
+
+namespace cao {
+constexpr size_t k_block_dimension = 4;
+constexpr size_t k_bytes_per_pixel = 4;
+
+using Block = std::array<uint8_t, k_block_dimension * k_block_dimension * k_bytes_per_pixel>;
+
+struct BlockRow
+{
+    size_t image;
+    size_t row;
+};
+
+void init_encoders()
+{
+    static auto once = std::once_flag{};
+    std::call_once(once, [] {
+        rgbcx::init();
+        bc7enc_compress_block_init();
+    });
+}
+
+/// @brief rgbcx quality level, from 0 to 18
+[[nodiscard]] auto bc1_level(CompressionTier tier) noexcept -> uint32_t
+{
+    switch (tier)
+    {
+        case CompressionTier::Fast: return 1;
+        case CompressionTier::Balanced: return 10;
+        case CompressionTier::Max: return 18;
+    }
+    return 10;
+}
+
+[[nodiscard]] auto bc7_params(CompressionTier tier) noexcept -> bc7enc_compress_block_params
+{
+    auto params = bc7enc_compress_block_params{};
+    bc7enc_compress_block_params_init(&params);
+
+    // Linear weights, as perceptual ones degrade normal maps
+    bc7enc_compress_block_params_init_linear_weights(&params);
+
+    switch (tier)
+    {
+        case CompressionTier::Fast:
+        {
+            // Skips the partitioned modes, which are most of the search
+            params.m_max_partitions = 0;
+            params.m_uber_level     = 0;
+            break;
+        }
+        case CompressionTier::Balanced: break; // bc7enc defaults
+        case CompressionTier::Max:
+        {
+            params.m_max_partitions = BC7ENC_MAX_PARTITIONS;
+            params.m_uber_level     = BC7ENC_MAX_UBER_LEVEL;
+            break;
+        }
+    }
+    return params;
+}
+
+[[nodiscard]] auto is_bc7(DXGI_FORMAT format) noexcept -> bool
+{
+    return format == DXGI_FORMAT_BC7_UNORM || format == DXGI_FORMAT_BC7_UNORM_SRGB;
+}
+
+auto can_encode_on_cpu(const DirectX::TexMetadata &metadata, DXGI_FORMAT format) noexcept -> bool
+{
+    const bool supported_format = is_bc7(format) || format == DXGI_FORMAT_BC1_UNORM
+                                  || format == DXGI_FORMAT_BC1_UNORM_SRGB;
+
+    return supported_format && metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE3D;
+}
+
+auto cpu_encoder_input_format(DXGI_FORMAT format) noexcept -> DXGI_FORMAT
+{
+    // Keeping the sRGB flag avoids a color space conversion when the device converts the texture
+    return DirectX::IsSRGB(format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+}
+
+/// @brief Copies a block of pixels, repeating the last row and column for images smaller than a block
+void read_block(const DirectX::Image &image, size_t block_x, size_t block_y, Block &block) noexcept
+{
+    for (size_t y = 0; y < k_block_dimension; ++y)
+    {
+        const auto src_y = std::min(block_y * k_block_dimension + y, image.height - 1);
+        const auto *row  = image.pixels + src_y * image.rowPitch;
+
+        for (size_t x = 0; x < k_block_dimension; ++x)
+        {
+            const auto src_x = std::min(block_x * k_block_dimension + x, image.width - 1);
+            std::memcpy(&block[(y * k_block_dimension + x) * k_bytes_per_pixel],
+                        row + src_x * k_bytes_per_pixel,
+                        k_bytes_per_pixel);
+        }
+    }
+}
+
+auto encode_on_cpu(btu::tex::Texture &&tex, DXGI_FORMAT format, CompressionTier tier, Executor &executor)
+    -> tl::expected<btu::tex::Texture, btu::common::Error>
+{
+    const auto &input    = tex.get();
+    const auto &metadata = input.GetMetadata();
+
+    if (!can_encode_on_cpu(metadata, format) || metadata.format != cpu_encoder_input_format(format))
+        return tl::make_unexpected(btu::common::Error(std::make_error_code(std::errc::not_supported)));
+
+    init_encoders();
+
+    auto output_metadata   = metadata;
+    output_metadata.format = format;
+
+    auto output = DirectX::ScratchImage{};
+    if (const auto hr = output.Initialize(output_metadata); FAILED(hr))
+        return tl::make_unexpected(btu::common::Error(std::error_code(hr, std::system_category())));
+
+    const auto inputs  = std::span(input.GetImages(), input.GetImageCount());
+    const auto outputs = std::span(output.GetImages(), output.GetImageCount());
+
+    // A row of blocks is small enough to balance the work, and large enough to amortize scheduling
+    auto rows = std::vector<BlockRow>{};
+    for (size_t image = 0; image < inputs.size(); ++image)
+    {
+        const auto block_rows = (inputs[image].height + k_block_dimension - 1) / k_block_dimension;
+        for (size_t row = 0; row < block_rows; ++row)
+            rows.push_back(BlockRow{.image = image, .row = row});
+    }
+
+    const auto bc7_settings = bc7_params(tier);
+    const auto bc1_quality  = bc1_level(tier);
+
+    const bool bc7          = is_bc7(format);
+    const size_t block_size = bc7 ? 16 : 8;
+
+    const auto encode_row = [&](const BlockRow &row) {
+        const auto &src = inputs[row.image];
+        const auto &dst = outputs[row.image];
+
+        auto *out        = dst.pixels + row.row * dst.rowPitch;
+        const auto width = (src.width + k_block_dimension - 1) / k_block_dimension;
+
+        auto block = Block{};
+        for (size_t x = 0; x < width; ++x, out += block_size)
+        {
+            read_block(src, x, row.row, block);
+            if (bc7)
+                bc7enc_compress_block(out, block.data(), &bc7_settings);
+            else
+                rgbcx::encode_bc1(bc1_quality, out, block.data(), false, false);
+        }
+    };
+
+    // Nothing is left half written, so the encoding does not need to be stoppable
+    parallel_for_each(executor,
+                      Lane::Cpu,
+                      std::span(rows),
+                      executor.thread_count(Lane::Cpu),
+                      std::stop_token{},
+                      encode_row);
+
+    tex.set(std::move(output));
+    return std::move(tex);
+}
+} // namespace cao
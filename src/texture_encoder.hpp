@@ -0,0 +1,29 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include "executor.hpp"
+#include "settings/base_types.hpp"
+
+#include <btu/tex/texture.hpp>
+#include <DirectXTex.h>
+
+namespace cao {
+/// @brief Whether the CPU encoder can produce `format` from a texture described by `metadata`.
+/// Only BC1 and BC7 are supported, other formats go through the compression device
+[[nodiscard]] auto can_encode_on_cpu(const DirectX::TexMetadata &metadata, DXGI_FORMAT format) noexcept
+    -> bool;
+
+/// @brief The uncompressed format the texture must be converted to before calling `encode_on_cpu`
+[[nodiscard]] auto cpu_encoder_input_format(DXGI_FORMAT format) noexcept -> DXGI_FORMAT;
+
+/// @brief Compresses a texture with bc7enc or rgbcx.
+/// Rows of blocks are spread over the CPU lane of `executor`, so large textures use several threads
+/// @param tex Must use the format returned by `cpu_encoder_input_format`
+[[nodiscard]] auto encode_on_cpu(btu::tex::Texture &&tex,
+                                 DXGI_FORMAT format,
+                                 CompressionTier tier,
+                                 Executor &executor) -> tl::expected<btu::tex::Texture, btu::common::Error>;
+} // namespace cao
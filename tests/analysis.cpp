@@ -0,0 +1,237 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "analysis.hpp"
+#include "settings/per_file_settings.hpp"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cao;
+
+using Steps = std::vector<std::string>;
+
+/// @brief Writes `value` as a little endian integer of `size` bytes at `offset`, growing `bytes` if needed
+void put_le(std::vector<std::byte> &bytes, size_t offset, uint64_t value, size_t size = 4)
+{
+    bytes.resize(std::max(bytes.size(), offset + size));
+    for (size_t i = 0; i < size; ++i)
+        bytes[offset + i] = static_cast<std::byte>((value >> (8 * i)) & 0xFF);
+}
+
+void put_string(std::vector<std::byte> &bytes, size_t offset, std::string_view str)
+{
+    bytes.resize(std::max(bytes.size(), offset + str.size()));
+    for (size_t i = 0; i < str.size(); ++i)
+        bytes[offset + i] = static_cast<std::byte>(str[i]);
+}
+
+[[nodiscard]] auto make_dds_header(uint32_t width, uint32_t height, uint32_t mips) -> std::vector<std::byte>
+{
+    auto header = std::vector<std::byte>(128);
+    put_string(header, 0, "DDS ");
+    put_le(header, 4, 124);
+    put_le(header, 12, height);
+    put_le(header, 16, width);
+    put_le(header, 28, mips);
+    put_le(header, 76, 32); // pixel format size
+    return header;
+}
+
+[[nodiscard]] auto make_compressed_dds_header(uint32_t width,
+                                              uint32_t height,
+                                              uint32_t mips,
+                                              std::string_view four_cc) -> std::vector<std::byte>
+{
+    auto header = make_dds_header(width, height, mips);
+    put_le(header, 80, 0x4); // four CC
+    put_string(header, 84, four_cc);
+    return header;
+}
+
+[[nodiscard]] auto make_tga_header(uint16_t width, uint16_t height, uint8_t depth) -> std::vector<std::byte>
+{
+    auto header = std::vector<std::byte>(18);
+    put_le(header, 2, 2, 1); // uncompressed true color
+    put_le(header, 12, width, 2);
+    put_le(header, 14, height, 2);
+    put_le(header, 16, depth, 1);
+    return header;
+}
+
+[[nodiscard]] auto make_nif_header(uint32_t stream_version) -> std::vector<std::byte>
+{
+    constexpr auto k_header_string = std::string_view("Gamebryo File Format, Version 20.2.0.7\n");
+
+    auto header = std::vector<std::byte>{};
+    put_string(header, 0, k_header_string);
+
+    auto offset = k_header_string.size();
+    put_le(header, offset, 0x14020007); // version
+    put_le(header, offset + 4, 1, 1);   // little endian
+    put_le(header, offset + 5, 12);     // user version
+    put_le(header, offset + 9, 42);     // block count
+    put_le(header, offset + 13, stream_version);
+    return header;
+}
+
+[[nodiscard]] auto make_hkx_header(uint8_t pointer_size) -> std::vector<std::byte>
+{
+    auto header = std::vector<std::byte>{};
+    put_le(header, 0, 0x57E0E057);
+    put_le(header, 4, 0x10C0C010);
+    put_le(header, 12, 8); // file version
+    put_le(header, 16, pointer_size, 1);
+    put_le(header, 17, 1, 1); // little endian
+    put_le(header, 18, 0, 1); // reuse padding
+    put_le(header, 19, 1, 1); // empty base class
+    put_string(header, 40, "hk_2010.2.0-r1");
+    return header;
+}
+
+[[nodiscard]] auto make_analysis_settings() -> PerFileSettings
+{
+    auto sets         = PerFileSettings::make_base(btu::Game::SSE);
+    sets.tex.compress = true;
+    sets.tex.mipmaps  = true;
+    sets.tex.resize   = std::monostate{};
+    sets.nif.optimize = true;
+    return sets;
+}
+
+TEST_CASE("DDS headers")
+{
+    auto sets = make_analysis_settings();
+
+    SUBCASE("Compressed texture with all its mipmaps")
+    {
+        const auto header   = make_compressed_dds_header(256, 256, 9, "DXT1");
+        const auto analysis = analyze_header("textures/a.dds", header, 1000, sets);
+        REQUIRE(analysis.has_value());
+        CHECK(analysis->type == FileType::Texture);
+        CHECK(analysis->steps.empty());
+        CHECK(analysis->estimated_size == 1000);
+    }
+
+    SUBCASE("Uncompressed texture without mipmaps")
+    {
+        auto header = make_dds_header(256, 128, 1);
+        put_le(header, 80, 0x41); // RGB and alpha pixels
+        put_le(header, 88, 32);
+
+        const auto analysis = analyze_header("textures/a.dds", header, 256 * 128 * 4 + 128, sets);
+        REQUIRE(analysis.has_value());
+        CHECK(analysis->steps == Steps{"compress", "generate mipmaps"});
+        // BC3 with a full mip chain
+        CHECK(analysis->estimated_size == 128 + 256 * 128 * 4 / 3);
+    }
+
+    SUBCASE("DX10 header")
+    {
+        auto header = make_compressed_dds_header(64, 64, 7, "DX10");
+        put_le(header, 128, 98); // BC7_UNORM
+
+        sets.tex.resize     = btu::tex::Dimension{.w = 32, .h = 32};
+        const auto analysis = analyze_header("textures/a.dds", header, 6000, sets);
+        REQUIRE(analysis.has_value());
+        CHECK(analysis->steps == Steps{"resize to 32x32"});
+        CHECK(analysis->estimated_size == 148 + 32 * 32 * 4 / 3);
+    }
+
+    SUBCASE("Forced conversion")
+    {
+        sets.tex_optimize   = OptimizeType::Forced;
+        const auto header   = make_compressed_dds_header(4, 4, 3, "DXT5");
+        const auto analysis = analyze_header("textures/a.dds", header, 144, sets);
+        REQUIRE(analysis.has_value());
+        CHECK(analysis->steps == Steps{"convert (forced)"});
+    }
+
+    SUBCASE("Invalid headers")
+    {
+        auto wrong_magic = make_compressed_dds_header(64, 64, 7, "DXT1");
+        put_string(wrong_magic, 0, "DDX ");
+        CHECK_FALSE(analyze_header("a.dds", wrong_magic, 1000, sets).has_value());
+
+        auto truncated = make_compressed_dds_header(64, 64, 7, "DXT1");
+        truncated.resize(84);
+        CHECK_FALSE(analyze_header("a.dds", truncated, 84, sets).has_value());
+
+        // The DX10 header is missing
+        const auto no_dx10_header = make_compressed_dds_header(64, 64, 7, "DX10");
+        CHECK_FALSE(analyze_header("a.dds", no_dx10_header, 128, sets).has_value());
+    }
+}
+
+TEST_CASE("TGA headers")
+{
+    const auto sets = make_analysis_settings();
+
+    const auto header   = make_tga_header(64, 32, 32);
+    const auto analysis = analyze_header("textures/a.tga", header, 64 * 32 * 4 + 18, sets);
+    REQUIRE(analysis.has_value());
+    CHECK(analysis->steps == Steps{"convert to dds", "compress", "generate mipmaps"});
+    CHECK(analysis->estimated_size == 18 + 64 * 32 * 4 / 3);
+
+    auto truncated = make_tga_header(64, 32, 32);
+    truncated.resize(16);
+    CHECK_FALSE(analyze_header("textures/a.tga", truncated, 16, sets).has_value());
+}
+
+TEST_CASE("NIF stream version")
+{
+    auto sets = make_analysis_settings();
+
+    // The header alone cannot show whether the mesh can be optimized
+    const auto target = analyze_header("meshes/a.nif", make_nif_header(100), 1000, sets);
+    REQUIRE(target.has_value());
+    CHECK(target->type == FileType::Mesh);
+    CHECK(target->steps.empty());
+
+    const auto other_game = analyze_header("meshes/a.nif", make_nif_header(83), 1000, sets);
+    REQUIRE(other_game.has_value());
+    CHECK(other_game->steps == Steps{"convert to target game format"});
+
+    sets.nif_optimize = OptimizeType::Forced;
+    const auto forced = analyze_header("meshes/a.nif", make_nif_header(100), 1000, sets);
+    REQUIRE(forced.has_value());
+    CHECK(forced->steps == Steps{"convert to target game format"});
+
+    auto no_magic = make_nif_header(100);
+    put_string(no_magic, 0, "NetImmerse");
+    CHECK_FALSE(analyze_header("meshes/a.nif", no_magic, 1000, sets).has_value());
+
+    auto no_line_end = std::vector<std::byte>{};
+    put_string(no_line_end, 0, "Gamebryo File Format, Version 20.2.0.7");
+    CHECK_FALSE(analyze_header("meshes/a.nif", no_line_end, 1000, sets).has_value());
+}
+
+TEST_CASE("HKX pointer size")
+{
+    auto sets = make_analysis_settings();
+
+    const auto target = analyze_header("meshes/a.hkx", make_hkx_header(8), 1000, sets);
+    REQUIRE(target.has_value());
+    CHECK(target->type == FileType::Animation);
+    CHECK(target->steps.empty());
+
+    const auto other_game = analyze_header("meshes/a.hkx", make_hkx_header(4), 1000, sets);
+    REQUIRE(other_game.has_value());
+    CHECK(other_game->steps == Steps{"convert to 64 bits"});
+
+    sets.hkx_target      = btu::Game::SLE;
+    const auto legendary = analyze_header("meshes/a.hkx", make_hkx_header(8), 1000, sets);
+    REQUIRE(legendary.has_value());
+    CHECK(legendary->steps == Steps{"convert to 32 bits"});
+
+    auto truncated = make_hkx_header(8);
+    truncated.resize(16);
+    CHECK_FALSE(analyze_header("meshes/a.hkx", truncated, 16, sets).has_value());
+}
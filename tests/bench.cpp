@@ -0,0 +1,472 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+/// Runs process_file over a corpus of assets and prints latency and throughput as JSON.
+/// Files are read into memory first, so disk speed does not show in the results.
+///
+/// Usage: CAO_bench <corpus directory> [--profile NAME] [--iterations N] [--forced] [--compare-encoders]
+///                  [--output report.json]
+///
+/// `--forced` processes files even when they are already optimized, which is what most corpora need
+/// to exercise the optimization paths. HKX files are only measured if the animation converter is found.
+///
+/// Heap allocations made while a file is processed are counted, on all threads. `alloc_bytes_per_input_byte`
+/// grows by one for every full copy of the input made on the way, which makes extra copies easy to spot on
+/// large meshes.
+///
+/// `--compare-encoders` also processes every texture with each texture encoder, and reports their throughput
+/// and the PSNR of the first mip compared to the input.
+
+#include "main_process.hpp"
+#include "run_resources.hpp"
+#include "settings/settings.hpp"
+#include "version.hpp"
+
+#include <btu/tex/texture.hpp>
+#include <nlohmann/json.hpp>
+#include <DirectXTex.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+std::atomic_uint64_t g_allocation_count{0};
+std::atomic_uint64_t g_allocated_bytes{0};
+
+struct AllocationCounts
+{
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+
+    [[nodiscard]] static auto now() noexcept -> AllocationCounts
+    {
+        return {g_allocation_count.load(std::memory_order_relaxed),
+                g_allocated_bytes.load(std::memory_order_relaxed)};
+    }
+};
+
+struct BenchOptions
+{
+    std::filesystem::path corpus;
+    std::string profile = "SSE";
+    size_t iterations   = 3;
+    bool forced           = false;
+    bool compare_encoders = false;
+    std::optional<std::filesystem::path> output;
+};
+
+struct CorpusFile
+{
+    std::filesystem::path relative_path;
+    std::vector<std::byte> content;
+    cao::FileType type;
+};
+
+struct TypeResults
+{
+    std::vector<double> latencies_ms;
+    uint64_t bytes_in    = 0;
+    uint64_t bytes_out   = 0;
+    size_t processed     = 0;
+    size_t no_work       = 0;
+    size_t errors        = 0;
+    double total_seconds = 0;
+    uint64_t allocations     = 0;
+    uint64_t allocated_bytes = 0;
+};
+
+struct EncoderResults
+{
+    uint64_t bytes_in    = 0;
+    double total_seconds = 0;
+    double psnr_sum      = 0;
+    size_t psnr_count    = 0;
+    size_t errors        = 0;
+};
+
+[[nodiscard]] auto parse_options(int argc, char **argv) -> std::optional<BenchOptions>
+{
+    if (argc < 2)
+        return std::nullopt;
+
+    auto options = BenchOptions{.corpus = argv[1]};
+    for (int i = 2; i < argc; ++i)
+    {
+        const auto arg = std::string_view(argv[i]);
+        if (arg == "--profile" && i + 1 < argc)
+            options.profile = argv[++i];
+        else if (arg == "--forced")
+            options.forced = true;
+        else if (arg == "--compare-encoders")
+            options.compare_encoders = true;
+        else if (arg == "--iterations" && i + 1 < argc)
+        {
+            // Anything but a whole number is a usage error
+            const auto value     = std::string_view(argv[++i]);
+            size_t iterations    = 0;
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), iterations);
+            if (ec != std::errc{} || end != value.data() + value.size())
+                return std::nullopt;
+            options.iterations = std::max(iterations, size_t{1});
+        }
+        else if (arg == "--output" && i + 1 < argc)
+            options.output = argv[++i];
+        else
+            return std::nullopt;
+    }
+    return options;
+}
+
+[[nodiscard]] auto read_file(const std::filesystem::path &path) -> std::vector<std::byte>
+{
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    auto content = std::vector<std::byte>(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char *>(content.data()), static_cast<std::streamsize>(content.size()));
+    return content;
+}
+
+[[nodiscard]] auto load_corpus(const std::filesystem::path &directory) -> std::vector<CorpusFile>
+{
+    auto files = std::vector<CorpusFile>{};
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(directory))
+    {
+        if (!entry.is_regular_file())
+            continue;
+
+        const auto type = cao::guess_file_type(entry.path());
+        if (!type)
+            continue;
+
+        files.push_back(CorpusFile{
+            .relative_path = entry.path().lexically_relative(directory),
+            .content       = read_file(entry.path()),
+            .type          = *type,
+        });
+    }
+    // Directory iteration order is not stable, and results should be comparable across runs
+    std::ranges::sort(files, {}, &CorpusFile::relative_path);
+    return files;
+}
+
+/// @brief The first image of a texture, decoded to RGBA8
+[[nodiscard]] auto decode_first_image(const std::filesystem::path &path, std::span<const std::byte> content)
+    -> std::optional<DirectX::ScratchImage>
+{
+    auto tex = btu::tex::load(path, content);
+    if (!tex)
+        return std::nullopt;
+
+    const auto *image = tex->get().GetImage(0, 0, 0);
+    if (image == nullptr)
+        return std::nullopt;
+
+    constexpr auto k_format = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    auto decoded  = DirectX::ScratchImage{};
+    const auto hr = DirectX::IsCompressed(image->format)
+                        ? DirectX::Decompress(*image, k_format, decoded)
+                        : DirectX::Convert(*image, k_format, DirectX::TEX_FILTER_DEFAULT, 0.5F, decoded);
+    if (FAILED(hr))
+        return std::nullopt;
+    return decoded;
+}
+
+/// @brief Peak signal-to-noise ratio over all channels, or nothing if the images cannot be compared
+[[nodiscard]] auto psnr(const DirectX::Image &reference, const DirectX::Image &image) -> std::optional<double>
+{
+    // Identical images have an infinite PSNR, which JSON cannot represent
+    constexpr double k_max_psnr = 100.0;
+
+    if (reference.width != image.width || reference.height != image.height)
+        return std::nullopt;
+
+    double squared_error = 0;
+    for (size_t y = 0; y < image.height; ++y)
+    {
+        const auto *a = reference.pixels + y * reference.rowPitch;
+        const auto *b = image.pixels + y * image.rowPitch;
+        for (size_t x = 0; x < image.width * 4; ++x)
+        {
+            const auto diff = static_cast<double>(a[x]) - static_cast<double>(b[x]);
+            squared_error += diff * diff;
+        }
+    }
+
+    const auto mse = squared_error / static_cast<double>(image.width * image.height * 4);
+    if (mse == 0)
+        return k_max_psnr;
+    return std::min(10.0 * std::log10(255.0 * 255.0 / mse), k_max_psnr);
+}
+
+[[nodiscard]] auto percentile(std::span<const double> sorted, double fraction) -> double
+{
+    if (sorted.empty())
+        return 0;
+    const auto index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+[[nodiscard]] auto to_string(cao::FileType type) -> std::string_view
+{
+    switch (type)
+    {
+        case cao::FileType::Mesh: return "mesh";
+        case cao::FileType::Texture: return "texture";
+        case cao::FileType::Animation: return "animation";
+    }
+    return "unknown";
+}
+
+[[nodiscard]] auto to_json(TypeResults &results) -> nlohmann::json
+{
+    constexpr double k_bytes_per_mb = 1024.0 * 1024.0;
+
+    std::ranges::sort(results.latencies_ms);
+    const auto seconds = results.total_seconds;
+    const auto files   = results.latencies_ms.size();
+
+    return {
+        {"processed", results.processed},
+        {"no_work_required", results.no_work},
+        {"errors", results.errors},
+        {"p50_ms", percentile(results.latencies_ms, 0.50)},
+        {"p90_ms", percentile(results.latencies_ms, 0.90)},
+        {"p99_ms", percentile(results.latencies_ms, 0.99)},
+        {"max_ms", results.latencies_ms.empty() ? 0.0 : results.latencies_ms.back()},
+        {"bytes_in", results.bytes_in},
+        {"bytes_out", results.bytes_out},
+        {"files_per_s", seconds > 0 ? static_cast<double>(results.latencies_ms.size()) / seconds : 0.0},
+        {"mb_per_s", seconds > 0 ? static_cast<double>(results.bytes_in) / k_bytes_per_mb / seconds : 0.0},
+        {"allocations_per_file",
+         files > 0 ? static_cast<double>(results.allocations) / static_cast<double>(files) : 0.0},
+        {"alloc_bytes_per_input_byte",
+         results.bytes_in > 0
+             ? static_cast<double>(results.allocated_bytes) / static_cast<double>(results.bytes_in)
+             : 0.0},
+    };
+}
+
+[[nodiscard]] auto to_json(const EncoderResults &results) -> nlohmann::json
+{
+    constexpr double k_bytes_per_mb = 1024.0 * 1024.0;
+
+    const auto seconds = results.total_seconds;
+    return {
+        {"mb_per_s", seconds > 0 ? static_cast<double>(results.bytes_in) / k_bytes_per_mb / seconds : 0.0},
+        {"mean_psnr_db",
+         results.psnr_count > 0 ? results.psnr_sum / static_cast<double>(results.psnr_count) : 0.0},
+        {"compared_files", results.psnr_count},
+        {"errors", results.errors},
+    };
+}
+
+/// @brief Processes every texture with the given resources, and compares the result with the input
+[[nodiscard]] auto bench_encoder(std::span<const CorpusFile> corpus,
+                                 const cao::PerFileSettings &file_sets,
+                                 cao::RunResources &resources,
+                                 size_t iterations) -> EncoderResults
+{
+    auto results = EncoderResults{};
+    for (const auto &file : corpus)
+    {
+        if (file.type != cao::FileType::Texture)
+            continue;
+
+        const auto reference = decode_first_image(file.relative_path, file.content);
+
+        for (size_t iteration = 0; iteration < iterations; ++iteration)
+        {
+            auto content = file.content;
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto res
+                = cao::process_file(file.relative_path, std::move(content), file_sets, false, resources);
+            results.total_seconds
+                += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            results.bytes_in += file.content.size();
+
+            if (!res)
+            {
+                results.errors += res.error() == cao::k_error_no_work_required ? 0 : 1;
+                continue;
+            }
+
+            // Quality does not change across iterations
+            if (iteration != 0 || !reference)
+                continue;
+
+            const auto output = decode_first_image(file.relative_path, *res);
+            if (!output)
+                continue;
+
+            if (const auto value = psnr(*reference->GetImage(0, 0, 0), *output->GetImage(0, 0, 0)))
+            {
+                results.psnr_sum += *value;
+                ++results.psnr_count;
+            }
+        }
+    }
+    return results;
+}
+} // namespace
+
+// Counts every allocation of the process. Array and nothrow forms call these by default
+auto operator new(std::size_t size) -> void *
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const auto options = parse_options(argc, argv);
+    if (!options)
+    {
+        std::cerr << "Usage: CAO_bench <corpus directory> [--profile NAME] [--iterations N] [--forced] "
+                     "[--compare-encoders] [--output report.json]\n";
+        return 1;
+    }
+
+    const auto corpus = load_corpus(options->corpus);
+    if (corpus.empty())
+    {
+        std::cerr << "No mesh, texture or animation found in " << options->corpus.string() << '\n';
+        return 1;
+    }
+
+    auto settings = cao::Settings::make_base();
+    if (!settings.set_current_profile(std::u8string(options->profile.begin(), options->profile.end())))
+    {
+        std::cerr << "Unknown profile " << options->profile << '\n';
+        return 1;
+    }
+
+    auto file_sets = cao::current_per_file_settings(settings);
+    if (options->forced)
+    {
+        file_sets.nif_optimize = cao::OptimizeType::Forced;
+        file_sets.tex_optimize = cao::OptimizeType::Forced;
+        file_sets.hkx_optimize = cao::OptimizeType::Forced;
+    }
+
+    auto resources = cao::RunResources(settings.current_profile());
+    auto results   = std::array<TypeResults, 3>{};
+
+    // Setting up the animation converter fails when it is not installed, that is not a regression
+    const bool animations_available = resources.anim_exes.acquire().has_value();
+
+    const auto bench_start = std::chrono::steady_clock::now();
+    for (size_t iteration = 0; iteration < options->iterations; ++iteration)
+    {
+        for (const auto &file : corpus)
+        {
+            if (file.type == cao::FileType::Animation && !animations_available)
+                continue;
+
+            auto &type_results = results[static_cast<size_t>(file.type)];
+
+            // process_file consumes its input, the copy is made before measuring
+            auto content = file.content;
+
+            const auto allocations_before = AllocationCounts::now();
+            const auto start              = std::chrono::steady_clock::now();
+            const auto res
+                = cao::process_file(file.relative_path, std::move(content), file_sets, false, resources);
+
+            const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+            const auto allocations_after = AllocationCounts::now();
+
+            type_results.allocations += allocations_after.count - allocations_before.count;
+            type_results.allocated_bytes += allocations_after.bytes - allocations_before.bytes;
+
+            type_results.latencies_ms.push_back(elapsed.count() * 1000.0);
+            type_results.total_seconds += elapsed.count();
+            type_results.bytes_in += file.content.size();
+
+            if (res)
+            {
+                ++type_results.processed;
+                type_results.bytes_out += res->size();
+            }
+            else if (res.error() == cao::k_error_no_work_required)
+                ++type_results.no_work;
+            else
+                ++type_results.errors;
+        }
+    }
+    const auto wall_time = std::chrono::steady_clock::now() - bench_start;
+
+    auto types = nlohmann::json::object();
+    for (const auto type : {cao::FileType::Mesh, cao::FileType::Texture, cao::FileType::Animation})
+    {
+        auto &type_results = results[static_cast<size_t>(type)];
+        if (!type_results.latencies_ms.empty())
+            types[std::string(to_string(type))] = to_json(type_results);
+    }
+
+    auto encoders = nlohmann::json::object();
+    if (options->compare_encoders)
+    {
+        for (const auto encoder : {cao::TextureEncoder::Device, cao::TextureEncoder::Cpu})
+        {
+            auto profile            = settings.current_profile();
+            profile.texture_encoder = encoder;
+
+            auto encoder_resources = cao::RunResources(profile);
+            encoders[nlohmann::json(encoder).get<std::string>()]
+                = to_json(bench_encoder(corpus, file_sets, encoder_resources, options->iterations));
+        }
+    }
+
+    const auto report = nlohmann::json{
+        {"version", cao::k_cao_version},
+        {"corpus", options->corpus.string()},
+        {"profile", options->profile},
+        {"files", corpus.size()},
+        {"iterations", options->iterations},
+        {"forced", options->forced},
+        {"animations_available", animations_available},
+        {"types", std::move(types)},
+        {"stages", resources.statistics.to_json(wall_time)},
+        {"encoders", std::move(encoders)},
+    };
+
+    if (options->output)
+        std::ofstream(*options->output) << report.dump(4) << '\n';
+    else
+        std::cout << report.dump(4) << '\n';
+
+    return 0;
+}
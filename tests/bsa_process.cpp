@@ -0,0 +1,207 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "bsa_process.hpp"
+#include "utils.hpp"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace cao;
+
+/// @brief Appends `value` as a little endian integer of `size` bytes
+void put_le(std::string &bytes, uint64_t value, size_t size = 4)
+{
+    for (size_t i = 0; i < size; ++i)
+        bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+/// @brief Morrowind header, followed by an index that fits `file_count` files
+[[nodiscard]] auto make_tes3_archive(uint64_t file_count) -> std::string
+{
+    // Size and offset records, name offsets and 10 bytes of names
+    const uint64_t hash_offset = file_count * 12 + file_count * 4 + 10;
+
+    auto bytes = std::string{'\x00', '\x01', '\x00', '\x00'};
+    put_le(bytes, hash_offset);
+    put_le(bytes, file_count);
+    bytes.resize(12 + hash_offset + file_count * 8);
+    return bytes;
+}
+
+/// @brief Oblivion to Skyrim SE header, followed by an index that fits it exactly
+[[nodiscard]] auto make_tes4_archive(uint64_t version, uint64_t flags, uint64_t file_count) -> std::string
+{
+    constexpr uint64_t folder_count      = 1;
+    constexpr uint64_t folder_names_size = 5;
+    constexpr uint64_t file_names_size   = 10;
+
+    auto bytes = std::string("BSA", 4);
+    put_le(bytes, version);
+    put_le(bytes, 36);
+    put_le(bytes, flags);
+    put_le(bytes, folder_count);
+    put_le(bytes, file_count);
+    put_le(bytes, folder_names_size);
+    put_le(bytes, file_names_size);
+    put_le(bytes, 0); // file flags
+
+    const uint64_t folder_record_size = version == 105 ? 24 : 16;
+    bytes.resize(36 + folder_count * folder_record_size + file_count * 16
+                 + ((flags & 0x1U) != 0 ? folder_names_size + folder_count : 0)
+                 + ((flags & 0x2U) != 0 ? file_names_size : 0));
+    return bytes;
+}
+
+/// @brief Fallout 4 and Starfield header, followed by the records and a name table that fits it exactly
+[[nodiscard]] auto make_ba2_archive(uint64_t version, std::string_view type, uint64_t file_count)
+    -> std::string
+{
+    const uint64_t fixed_size  = version == 2 ? 32 : version == 3 ? 36 : 24;
+    const uint64_t record_size = type == "GNRL" ? 36 : 24;
+
+    auto bytes = std::string("BTDX");
+    put_le(bytes, version);
+    bytes += type;
+    put_le(bytes, file_count);
+
+    const auto name_table_offset = fixed_size + file_count * record_size;
+    put_le(bytes, name_table_offset, 8);
+    bytes.resize(name_table_offset + file_count * 2);
+    return bytes;
+}
+
+/// @brief Writes `bytes` as an archive and checks its header
+[[nodiscard]] auto check_header(std::string_view bytes, size_t expected_files) -> bool
+{
+    const auto directory    = test::TempDirectory{};
+    const auto archive_path = directory.path() / "archive.bsa";
+    test::write_file(archive_path, bytes);
+    return has_valid_archive_header(archive_path, expected_files);
+}
+
+TEST_CASE("Morrowind archive headers")
+{
+    const auto archive = make_tes3_archive(3);
+    CHECK(check_header(archive, 3));
+
+    SUBCASE("Wrong file count") { CHECK_FALSE(check_header(archive, 2)); }
+    SUBCASE("Truncated index") { CHECK_FALSE(check_header(archive.substr(0, archive.size() - 1), 3)); }
+    SUBCASE("Truncated header") { CHECK_FALSE(check_header(archive.substr(0, 8), 3)); }
+    SUBCASE("Hash table inside the records")
+    {
+        auto corrupted = archive;
+        corrupted[4]   = 1;
+        corrupted[5]   = 0;
+        CHECK_FALSE(check_header(corrupted, 3));
+    }
+}
+
+TEST_CASE("Oblivion to Skyrim SE archive headers")
+{
+    for (const uint64_t version : {103, 104, 105})
+    {
+        for (const uint64_t flags : {0x0, 0x1, 0x2, 0x3})
+        {
+            CAPTURE(version);
+            CAPTURE(flags);
+
+            const auto archive = make_tes4_archive(version, flags, 4);
+            CHECK(check_header(archive, 4));
+            CHECK_FALSE(check_header(archive, 5));
+            CHECK_FALSE(check_header(archive.substr(0, archive.size() - 1), 4));
+        }
+    }
+
+    const auto archive = make_tes4_archive(105, 0x3, 4);
+
+    SUBCASE("Truncated header") { CHECK_FALSE(check_header(archive.substr(0, 35), 4)); }
+    SUBCASE("Unsupported version")
+    {
+        auto corrupted = archive;
+        corrupted[4]   = 106;
+        CHECK_FALSE(check_header(corrupted, 4));
+    }
+    SUBCASE("Wrong folder offset")
+    {
+        auto corrupted = archive;
+        corrupted[8]   = 40;
+        CHECK_FALSE(check_header(corrupted, 4));
+    }
+    SUBCASE("More folders than files")
+    {
+        auto corrupted = archive;
+        corrupted[16]  = 5;
+        CHECK_FALSE(check_header(corrupted, 4));
+    }
+    SUBCASE("No folder for the files")
+    {
+        auto corrupted = archive;
+        corrupted[16]  = 0;
+        CHECK_FALSE(check_header(corrupted, 4));
+    }
+    SUBCASE("Names past the end of the file")
+    {
+        auto corrupted = archive;
+        corrupted[28]  = 100;
+        CHECK_FALSE(check_header(corrupted, 4));
+    }
+}
+
+TEST_CASE("Fallout 4 and Starfield archive headers")
+{
+    for (const uint64_t version : {1, 2, 3, 7, 8})
+    {
+        for (const auto *type : {"GNRL", "DX10", "GNMF"})
+        {
+            CAPTURE(version);
+            CAPTURE(type);
+
+            const auto archive = make_ba2_archive(version, type, 4);
+            CHECK(check_header(archive, 4));
+            CHECK_FALSE(check_header(archive, 3));
+            CHECK_FALSE(check_header(archive.substr(0, archive.size() - 1), 4));
+        }
+    }
+
+    const auto archive = make_ba2_archive(1, "GNRL", 4);
+
+    SUBCASE("Truncated header") { CHECK_FALSE(check_header(archive.substr(0, 20), 4)); }
+    SUBCASE("Unsupported version")
+    {
+        auto corrupted = archive;
+        corrupted[4]   = 4;
+        CHECK_FALSE(check_header(corrupted, 4));
+    }
+    SUBCASE("Unknown type")
+    {
+        auto corrupted = archive;
+        corrupted[8]   = 'X';
+        CHECK_FALSE(check_header(corrupted, 4));
+    }
+    SUBCASE("Name table inside the records")
+    {
+        auto corrupted = archive;
+        corrupted[16]  = 24;
+        CHECK_FALSE(check_header(corrupted, 4));
+    }
+}
+
+TEST_CASE("Archives of an unknown format")
+{
+    CHECK_FALSE(check_header("", 0));
+    CHECK_FALSE(check_header("BSA", 0));
+    CHECK_FALSE(check_header(std::string(64, 'x'), 0));
+
+    auto archive = make_ba2_archive(1, "GNRL", 1);
+    archive[0]   = 'C';
+    CHECK_FALSE(check_header(archive, 1));
+
+    const auto directory = test::TempDirectory{};
+    CHECK_FALSE(has_valid_archive_header(directory.path() / "missing.bsa", 0));
+}
@@ -0,0 +1,77 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "conflict_index.hpp"
+#include "utils.hpp"
+
+#include <doctest/doctest.h>
+
+#include <array>
+
+using namespace cao;
+
+/// @brief Mods sharing some files, lowest priority first
+struct ConflictingMods
+{
+    ConflictingMods()
+    {
+        test::write_file(mods[0] / "textures" / "shared.dds");
+        test::write_file(mods[0] / "meshes" / "only_low.nif");
+        test::write_file(mods[0] / "readme.txt");
+
+        // Different case, same file for the game
+        test::write_file(mods[1] / "Textures" / "SHARED.DDS");
+        test::write_file(mods[1] / "meshes" / "only_high.nif");
+        test::write_file(mods[1] / "readme.txt");
+    }
+
+    test::TempDirectory directory;
+    std::array<btu::Path, 2> mods{directory.path() / "Low", directory.path() / "High"};
+};
+
+TEST_CASE("ConflictIndex gives files provided by several mods to the one with the highest priority")
+{
+    const auto fixture = ConflictingMods{};
+    auto executor      = Executor(1, 2);
+
+    const auto index = ConflictIndex::build(fixture.mods,
+                                            btu::bsa::Settings::get(btu::Game::SSE),
+                                            /*extract_archives=*/false,
+                                            executor,
+                                            2,
+                                            std::stop_token{});
+
+    // Files CAO does not process are not indexed
+    CHECK(index.size() == 1);
+
+    CHECK(index.is_overridden(fixture.mods[0], "textures/shared.dds"));
+    CHECK(index.is_overridden(fixture.mods[0], "TEXTURES/Shared.dds"));
+    CHECK_FALSE(index.is_overridden(fixture.mods[1], "textures/shared.dds"));
+
+    CHECK_FALSE(index.is_overridden(fixture.mods[0], "meshes/only_low.nif"));
+    CHECK_FALSE(index.is_overridden(fixture.mods[1], "meshes/only_high.nif"));
+
+    // Mods that were not indexed are never overridden
+    CHECK_FALSE(index.is_overridden(fixture.directory.path() / "Unknown", "textures/shared.dds"));
+}
+
+TEST_CASE("ConflictIndex is empty when stopped")
+{
+    const auto fixture = ConflictingMods{};
+    auto executor      = Executor(1, 2);
+
+    auto stop_source = std::stop_source{};
+    stop_source.request_stop();
+
+    const auto index = ConflictIndex::build(fixture.mods,
+                                            btu::bsa::Settings::get(btu::Game::SSE),
+                                            /*extract_archives=*/false,
+                                            executor,
+                                            2,
+                                            stop_source.get_token());
+
+    CHECK(index.size() == 0);
+    CHECK_FALSE(index.is_overridden(fixture.mods[0], "textures/shared.dds"));
+}
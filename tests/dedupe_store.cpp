@@ -0,0 +1,102 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "dedupe_store.hpp"
+
+#include <doctest/doctest.h>
+
+using namespace cao;
+
+using Future = std::shared_future<DedupeStore::Result>;
+
+[[nodiscard]] auto make_output(size_t size) -> std::vector<std::byte>
+{
+    return std::vector<std::byte>(size, std::byte{0x2A});
+}
+
+TEST_CASE("DedupeStore gives the output of the first file to the identical ones")
+{
+    auto store = DedupeStore(1024);
+
+    auto first = store.acquire(1);
+    REQUIRE(std::holds_alternative<DedupeStore::Claim>(first));
+
+    // Arrives while the first file is being processed
+    const auto second = store.acquire(1);
+    REQUIRE(std::holds_alternative<Future>(second));
+
+    // Another key is independent
+    CHECK(std::holds_alternative<DedupeStore::Claim>(store.acquire(2)));
+
+    const auto output = make_output(100);
+    std::get<DedupeStore::Claim>(first).publish(output);
+    CHECK(store.stored_bytes() == output.size());
+
+    const auto result = std::get<Future>(second).get();
+    REQUIRE(result.output != nullptr);
+    CHECK(*result.output == output);
+    CHECK_FALSE(result.failed);
+
+    // Arrives once the first file is done
+    const auto third = store.acquire(1);
+    REQUIRE(std::holds_alternative<Future>(third));
+    CHECK(*std::get<Future>(third).get().output == output);
+}
+
+TEST_CASE("DedupeStore does not keep outputs beyond its limit")
+{
+    auto store = DedupeStore(64);
+
+    auto first        = store.acquire(1);
+    const auto second = store.acquire(1);
+
+    const auto output = make_output(100);
+    std::get<DedupeStore::Claim>(first).publish(output);
+    CHECK(store.stored_bytes() == 0);
+
+    // Files that were already waiting still get the output
+    const auto result = std::get<Future>(second).get();
+    REQUIRE(result.output != nullptr);
+    CHECK(*result.output == output);
+
+    // Later files are processed again
+    CHECK(std::holds_alternative<DedupeStore::Claim>(store.acquire(1)));
+}
+
+TEST_CASE("DedupeStore shares failures and unchanged files")
+{
+    auto store = DedupeStore(1024);
+
+    auto failed        = store.acquire(1);
+    const auto waiting = store.acquire(1);
+    std::get<DedupeStore::Claim>(failed).publish_unchanged(/*failed=*/true);
+
+    const auto result = std::get<Future>(waiting).get();
+    CHECK(result.output == nullptr);
+    CHECK(result.failed);
+
+    auto unchanged = store.acquire(2);
+    std::get<DedupeStore::Claim>(unchanged).publish_unchanged(/*failed=*/false);
+
+    const auto later = store.acquire(2);
+    REQUIRE(std::holds_alternative<Future>(later));
+    CHECK(std::get<Future>(later).get().output == nullptr);
+    CHECK_FALSE(std::get<Future>(later).get().failed);
+}
+
+TEST_CASE("DedupeStore lets identical files be processed when a claim is abandoned")
+{
+    auto store = DedupeStore(1024);
+
+    auto waiting = [&] {
+        auto claim = store.acquire(1);
+        return store.acquire(1);
+    }();
+
+    REQUIRE(std::holds_alternative<Future>(waiting));
+    CHECK_THROWS_AS(std::get<Future>(waiting).get(), std::future_error);
+
+    CHECK(std::holds_alternative<DedupeStore::Claim>(store.acquire(1)));
+}
@@ -0,0 +1,62 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "hash.hpp"
+
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+using namespace cao;
+
+TEST_CASE("hash_bytes is deterministic and depends on the seed")
+{
+    const auto data = std::string("Cathedral Assets Optimizer");
+
+    CHECK(hash_string(data) == hash_string(data));
+    CHECK(hash_string(data, 1) == hash_string(data, 1));
+    CHECK(hash_string(data) != hash_string(data, 1));
+    CHECK(hash_string(data) == hash_bytes(std::as_bytes(std::span(data))));
+}
+
+TEST_CASE("hash_bytes depends on every byte, including the ones of an incomplete block")
+{
+    // Sizes around the 32 bytes block
+    for (const size_t size : {1, 7, 8, 31, 32, 33, 63, 64, 65, 100})
+    {
+        CAPTURE(size);
+        auto data       = std::vector<std::byte>(size, std::byte{0x42});
+        const auto hash = hash_bytes(data);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            CAPTURE(i);
+            auto changed = data;
+            changed[i]   = std::byte{0x43};
+            CHECK(hash_bytes(changed) != hash);
+        }
+    }
+}
+
+TEST_CASE("hash_bytes depends on the size, even when the padding matches")
+{
+    // The last block is padded with zeros
+    const auto shorter = std::vector<std::byte>(31, std::byte{0});
+    const auto longer  = std::vector<std::byte>(32, std::byte{0});
+
+    CHECK(hash_bytes(shorter) != hash_bytes(longer));
+    CHECK(hash_bytes({}) != hash_bytes(std::vector<std::byte>(1, std::byte{0})));
+}
+
+TEST_CASE("hash_combine depends on the order of its arguments")
+{
+    const auto a = hash_string("a");
+    const auto b = hash_string("b");
+
+    CHECK(hash_combine(a, b) == hash_combine(a, b));
+    CHECK(hash_combine(a, b) != hash_combine(b, a));
+    CHECK(hash_combine(a, b) != hash_combine(a, a));
+}
@@ -0,0 +1,131 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "journal.hpp"
+#include "utils.hpp"
+
+#include <doctest/doctest.h>
+
+using namespace cao;
+
+TEST_CASE("Journal entries are kept by a resumed run")
+{
+    const auto directory    = test::TempDirectory{};
+    const auto journal_path = directory.path() / Journal::k_file_name;
+    const auto input_path   = std::filesystem::path("C:/Mods");
+
+    {
+        auto journal = Journal(journal_path, input_path, /*resume=*/false);
+        CHECK_FALSE(journal.has_previous_files());
+
+        journal.record_mod_done("C:/Mods/First Mod");
+        journal.record_archives_packed("C:/Mods/Second Mod");
+        journal.record_file_transformed("C:/Mods/Second Mod/textures/a.dds", FileSource::Loose, 42);
+        journal.record_file_transformed("C:/Mods/Second Mod/meshes/b.nif", FileSource::Archive, 43);
+
+        // Entries are visible before they are written
+        CHECK(journal.is_mod_done("C:/Mods/First Mod"));
+    }
+
+    SUBCASE("Resuming the same input")
+    {
+        const auto journal = Journal(journal_path, input_path, /*resume=*/true);
+        CHECK(journal.has_previous_files());
+
+        // Paths are compared ignoring case
+        CHECK(journal.is_mod_done("c:/mods/FIRST MOD"));
+        CHECK_FALSE(journal.is_mod_done("C:/Mods/Second Mod"));
+
+        CHECK(journal.are_archives_packed("C:/Mods/Second Mod"));
+        CHECK_FALSE(journal.are_archives_packed("C:/Mods/First Mod"));
+
+        CHECK(journal.is_file_transformed("C:/Mods/Second Mod/textures/a.dds", FileSource::Loose, 42));
+        CHECK(journal.is_file_transformed("C:/Mods/Second Mod/meshes/b.nif", FileSource::Archive, 43));
+
+        // A different content, or the other copy of the file
+        const auto texture_path = std::filesystem::path("C:/Mods/Second Mod/textures/a.dds");
+        CHECK_FALSE(journal.is_file_transformed(texture_path, FileSource::Loose, 41));
+        CHECK_FALSE(journal.is_file_transformed(texture_path, FileSource::Archive, 42));
+    }
+
+    SUBCASE("Resuming another input")
+    {
+        const auto journal = Journal(journal_path, "C:/Other Mods", /*resume=*/true);
+        CHECK_FALSE(journal.has_previous_files());
+        CHECK_FALSE(journal.is_mod_done("C:/Mods/First Mod"));
+    }
+
+    SUBCASE("Not resuming")
+    {
+        const auto journal = Journal(journal_path, input_path, /*resume=*/false);
+        CHECK_FALSE(journal.has_previous_files());
+        CHECK_FALSE(journal.is_mod_done("C:/Mods/First Mod"));
+    }
+}
+
+TEST_CASE("Journal ignores a line cut by a crash")
+{
+    const auto directory    = test::TempDirectory{};
+    const auto journal_path = directory.path() / Journal::k_file_name;
+    const auto input_path   = std::filesystem::path("C:/Mods");
+
+    {
+        auto journal = Journal(journal_path, input_path, /*resume=*/false);
+        journal.record_mod_done("C:/Mods/First Mod");
+    }
+
+    {
+        std::ofstream stream(journal_path, std::ios::app);
+        stream << R"({"kind":"mod_done","pa)";
+    }
+
+    const auto journal = Journal(journal_path, input_path, /*resume=*/true);
+    CHECK(journal.is_mod_done("C:/Mods/First Mod"));
+}
+
+TEST_CASE("Journal ignores corrupted lines")
+{
+    const auto directory    = test::TempDirectory{};
+    const auto journal_path = directory.path() / Journal::k_file_name;
+    const auto input_path   = std::filesystem::path("C:/Mods");
+
+    {
+        auto journal = Journal(journal_path, input_path, /*resume=*/false);
+        journal.record_mod_done("C:/Mods/First Mod");
+    }
+
+    {
+        // Valid JSON, with fields of the wrong type
+        std::ofstream stream(journal_path, std::ios::app);
+        stream << R"([1, 2, 3])" << '\n';
+        stream << R"({"kind":42,"path":"c:/mods/second mod"})" << '\n';
+        stream << R"({"kind":"mod_done","path":["c:/mods/second mod"]})" << '\n';
+        stream << R"({"kind":"file_transformed","path":"loose:c:/mods/a.dds","hash":"42"})" << '\n';
+        stream << R"({"kind":"file_transformed","path":"loose:c:/mods/b.dds","hash":-42})" << '\n';
+        stream << R"({"kind":"mod_done","path":"c:/mods/third mod"})" << '\n';
+    }
+
+    const auto journal = Journal(journal_path, input_path, /*resume=*/true);
+    CHECK(journal.is_mod_done("C:/Mods/First Mod"));
+    CHECK(journal.is_mod_done("C:/Mods/Third Mod"));
+    CHECK_FALSE(journal.is_mod_done("C:/Mods/Second Mod"));
+    CHECK_FALSE(journal.has_previous_files());
+}
+
+TEST_CASE("A finished journal is not resumed")
+{
+    const auto directory    = test::TempDirectory{};
+    const auto journal_path = directory.path() / Journal::k_file_name;
+    const auto input_path   = std::filesystem::path("C:/Mods");
+
+    {
+        auto journal = Journal(journal_path, input_path, /*resume=*/false);
+        journal.record_mod_done("C:/Mods/First Mod");
+        journal.finish();
+    }
+
+    const auto journal = Journal(journal_path, input_path, /*resume=*/true);
+    CHECK_FALSE(journal.is_mod_done("C:/Mods/First Mod"));
+}
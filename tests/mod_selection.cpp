@@ -0,0 +1,137 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "mod_selection.hpp"
+#include "utils.hpp"
+
+#include <doctest/doctest.h>
+
+using namespace cao;
+
+using Names = std::vector<std::u8string>;
+
+/// @brief MO2 instance with a few mods, where `modlist.txt` has Windows line endings
+struct Mo2Instance
+{
+    Mo2Instance()
+    {
+        test::write_file(directory.path() / "ModOrganizer.ini",
+                         "[General]\r\n"
+                         "gameName=Skyrim Special Edition\r\n"
+                         "selected_profile=@ByteArray(My Profile)\r\n");
+
+        test::write_file(directory.path() / "profiles" / "My Profile" / "modlist.txt",
+                         "# This file was automatically generated by Mod Organizer.\r\n"
+                         "+High Priority\r\n"
+                         "-Disabled Mod\r\n"
+                         "+Blacklisted Mod\r\n"
+                         "+Textures_separator\r\n"
+                         "*DLC: Dawnguard\r\n"
+                         "+Not Installed\r\n"
+                         "+Low Priority\r\n");
+
+        for (const auto *name : {"High Priority", "Disabled Mod", "Blacklisted Mod", "Low Priority"})
+            std::filesystem::create_directories(mods_directory() / name);
+    }
+
+    [[nodiscard]] auto mods_directory() const -> std::filesystem::path { return directory.path() / "mods"; }
+
+    test::TempDirectory directory;
+};
+
+TEST_CASE("read_mo2_modlist keeps the enabled mods of the selected profile, lowest priority first")
+{
+    const auto instance = Mo2Instance{};
+
+    const auto mods = read_mo2_modlist(instance.mods_directory());
+    REQUIRE(mods.has_value());
+    CHECK(*mods == Names{u8"Low Priority", u8"Not Installed", u8"Blacklisted Mod", u8"High Priority"});
+}
+
+TEST_CASE("read_mo2_modlist uses the default profile when none is selected")
+{
+    const auto directory = test::TempDirectory{};
+    test::write_file(directory.path() / "profiles" / "Default" / "modlist.txt", "+First\n+Second\n");
+
+    const auto mods = read_mo2_modlist(directory.path() / "mods");
+    REQUIRE(mods.has_value());
+    CHECK(*mods == Names{u8"Second", u8"First"});
+}
+
+TEST_CASE("read_mo2_modlist honors the custom directories of the instance")
+{
+    const auto directory = test::TempDirectory{};
+    test::write_file(directory.path() / "ModOrganizer.ini",
+                     "[General]\n"
+                     "selected_profile=@ByteArray(Custom)\n"
+                     "[Settings]\n"
+                     "mod_directory=%BASE_DIR%/My Mods\n"
+                     "profiles_directory=%BASE_DIR%/My Profiles\n");
+    test::write_file(directory.path() / "My Profiles" / "Custom" / "modlist.txt", "+First\n+Second\n");
+    test::write_file(directory.path() / "profiles" / "Custom" / "modlist.txt", "+Wrong\n");
+    std::filesystem::create_directories(directory.path() / "My Mods");
+
+    const auto mods = read_mo2_modlist(directory.path() / "My Mods");
+    REQUIRE(mods.has_value());
+    CHECK(*mods == Names{u8"Second", u8"First"});
+}
+
+TEST_CASE("read_mo2_modlist gives nothing without a modlist")
+{
+    const auto directory = test::TempDirectory{};
+    CHECK_FALSE(read_mo2_modlist(directory.path() / "mods").has_value());
+}
+
+TEST_CASE("read_vortex_manifest lists every deployed mod once, alphabetically")
+{
+    const auto directory = test::TempDirectory{};
+    test::write_file(directory.path() / "vortex.deployment.json",
+                     R"({"files": [{"source": "B"}, {"source": "A"}, {"source": "B"}]})");
+
+    const auto mods = read_vortex_manifest(directory.path());
+    REQUIRE(mods.has_value());
+    CHECK(*mods == Names{u8"A", u8"B"});
+}
+
+TEST_CASE("is_blacklisted ignores the case of mod names")
+{
+    // Patterns are lowercased by the caller
+    const auto blacklist = Names{u8"*blacklisted*", u8"unofficial * patch"};
+
+    CHECK(is_blacklisted(u8"Blacklisted Mod", blacklist));
+    CHECK(is_blacklisted(u8"BLACKLISTED", blacklist));
+    CHECK(is_blacklisted(u8"Unofficial Skyrim Patch", blacklist));
+    CHECK_FALSE(is_blacklisted(u8"Other Mod", blacklist));
+    CHECK_FALSE(is_blacklisted(u8"Other Mod", {}));
+}
+
+TEST_CASE("select_mods keeps the enabled mods, by priority")
+{
+    const auto instance  = Mo2Instance{};
+    const auto blacklist = Names{u8"BLACKLISTED*"};
+
+    const auto selection = select_mods(instance.mods_directory(),
+                                       btu::modmanager::ModManager::MO2,
+                                       blacklist);
+    CHECK(selection.by_priority);
+    CHECK(selection.mods
+          == std::vector<btu::Path>{instance.mods_directory() / "Low Priority",
+                                    instance.mods_directory() / "High Priority"});
+}
+
+TEST_CASE("select_mods keeps every mod, alphabetically, without a mod manager")
+{
+    const auto instance  = Mo2Instance{};
+    const auto blacklist = Names{u8"blacklisted*"};
+
+    const auto selection = select_mods(instance.mods_directory(),
+                                       btu::modmanager::ModManager::None,
+                                       blacklist);
+    CHECK_FALSE(selection.by_priority);
+    CHECK(selection.mods
+          == std::vector<btu::Path>{instance.mods_directory() / "Disabled Mod",
+                                    instance.mods_directory() / "High Priority",
+                                    instance.mods_directory() / "Low Priority"});
+}
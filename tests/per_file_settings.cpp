@@ -0,0 +1,112 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "settings/per_file_settings.hpp"
+#include "settings/per_file_settings_matcher.hpp"
+#include "settings/profile.hpp"
+
+#include <doctest/doctest.h>
+
+#include <array>
+
+using namespace cao;
+
+[[nodiscard]] auto wildcard_extension(std::u8string pattern) -> std::optional<std::u8string>
+{
+    return Pattern(std::move(pattern), Pattern::Type::Wildcard).extension();
+}
+
+[[nodiscard]] auto regex_extension(std::u8string pattern) -> std::optional<std::u8string>
+{
+    return Pattern(std::move(pattern), Pattern::Type::Regex).extension();
+}
+
+TEST_CASE("Pattern::extension of wildcards")
+{
+    CHECK(wildcard_extension(u8"*.dds") == u8"dds");
+    CHECK(wildcard_extension(u8"textures/*.DDS") == u8"dds");
+    CHECK(wildcard_extension(u8"*.Nif") == u8"nif");
+    CHECK(wildcard_extension(u8"*.tar.gz") == u8"gz");
+
+    CHECK_FALSE(wildcard_extension(u8"*").has_value());
+    CHECK_FALSE(wildcard_extension(u8"*.").has_value());
+    CHECK_FALSE(wildcard_extension(u8"*.dd?").has_value());
+    CHECK_FALSE(wildcard_extension(u8"*.d*").has_value());
+    CHECK_FALSE(wildcard_extension(u8"textures/*").has_value());
+}
+
+TEST_CASE("Pattern::extension of regexes")
+{
+    CHECK(regex_extension(u8R"(.*\.dds)") == u8"dds");
+    CHECK(regex_extension(u8R"(textures\\.*\.DDS)") == u8"dds");
+    CHECK(regex_extension(u8R"(.*\\\.hkx)") == u8"hkx");
+
+    // An unescaped dot matches any character
+    CHECK_FALSE(regex_extension(u8R"(.*.dds)").has_value());
+    // An escaped backslash followed by any character
+    CHECK_FALSE(regex_extension(u8R"(.*\\.dds)").has_value());
+    // Alternatives can have different extensions
+    CHECK_FALSE(regex_extension(u8R"(.*\.nif|.*\.dds)").has_value());
+    CHECK_FALSE(regex_extension(u8R"(.*\.(dds|png))").has_value());
+    CHECK_FALSE(regex_extension(u8R"(.*\.dd.)").has_value());
+}
+
+[[nodiscard]] auto make_settings(std::u8string pattern, Pattern::Type type = Pattern::Type::Wildcard)
+    -> PerFileSettings
+{
+    auto settings    = PerFileSettings{};
+    settings.pattern = Pattern(std::move(pattern), type);
+    return settings;
+}
+
+TEST_CASE("PerFileSettingsMatcher finds the same settings as the linear lookup")
+{
+    auto profile = Profile{};
+    profile.append_per_file_settings(make_settings(u8"*.dds"));
+    profile.append_per_file_settings(make_settings(u8R"(.*\.NIF)", Pattern::Type::Regex));
+    profile.append_per_file_settings(make_settings(u8"textures/*"));
+    profile.append_per_file_settings(make_settings(u8R"(meshes\\.*)", Pattern::Type::Regex));
+    profile.append_per_file_settings(make_settings(u8"*.png"));
+    profile.append_per_file_settings(make_settings(u8"*.DDS"));
+    profile.append_per_file_settings(make_settings(u8R"(.*\.nif|.*\.hkx)", Pattern::Type::Regex));
+
+    const auto matcher = PerFileSettingsMatcher(std::as_const(profile).per_file_settings());
+    REQUIRE(matcher.size() == 8);
+
+    constexpr auto paths = std::array{
+        u8"textures/a.dds",
+        u8"Textures/B.DDS",
+        u8"textures/c.png",
+        u8"textures/d.tga",
+        u8"meshes/e.nif",
+        u8"MESHES/F.NIF",
+        u8"meshes/g.hkx",
+        u8"meshes/animations/h.HKX",
+        u8"sound/i.wav",
+        u8"j",
+        u8"k.dds.nif",
+        u8"interface/l.swf",
+    };
+
+    for (const auto *path_text : paths)
+    {
+        const auto path = std::filesystem::path(path_text);
+        CAPTURE(path.string());
+        CHECK(&matcher.find(path) == &profile.get_per_file_settings(path));
+    }
+}
+
+TEST_CASE("PerFileSettingsMatcher falls back to the base settings")
+{
+    auto profile = Profile{};
+    profile.append_per_file_settings(make_settings(u8"*.dds"));
+
+    const auto settings = std::as_const(profile).per_file_settings();
+    const auto matcher  = PerFileSettingsMatcher(settings);
+
+    CHECK(&matcher.find(u8"meshes/a.nif") == settings.back());
+    CHECK(matcher.find_index(u8"meshes/a.nif") == settings.size() - 1);
+    CHECK(matcher.find_index(u8"textures/a.dds") == 0);
+}
@@ -0,0 +1,130 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "texture_encoder.hpp"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+using namespace cao;
+
+/// @brief RGBA texture with smooth gradients, as found in most textures. Every mip level has the same pattern
+[[nodiscard]] auto make_gradient_texture(size_t width, size_t height, size_t mips) -> btu::tex::Texture
+{
+    auto image = DirectX::ScratchImage{};
+    REQUIRE(SUCCEEDED(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, mips)));
+
+    for (const auto &level : std::span(image.GetImages(), image.GetImageCount()))
+    {
+        for (size_t y = 0; y < level.height; ++y)
+        {
+            auto *row = level.pixels + y * level.rowPitch;
+            for (size_t x = 0; x < level.width; ++x)
+            {
+                row[x * 4 + 0] = static_cast<uint8_t>(40 + 2 * x);
+                row[x * 4 + 1] = static_cast<uint8_t>(60 + 3 * y);
+                row[x * 4 + 2] = static_cast<uint8_t>(80 + x + y);
+                row[x * 4 + 3] = 255;
+            }
+        }
+    }
+
+    auto tex = btu::tex::Texture{};
+    tex.set(std::move(image));
+    return tex;
+}
+
+/// @brief Peak signal-to-noise ratio over all channels, capped for identical images
+[[nodiscard]] auto psnr(const DirectX::Image &reference, const DirectX::Image &image) -> double
+{
+    constexpr double k_max_psnr = 100.0;
+
+    double squared_error = 0;
+    for (size_t y = 0; y < image.height; ++y)
+    {
+        const auto *a = reference.pixels + y * reference.rowPitch;
+        const auto *b = image.pixels + y * image.rowPitch;
+        for (size_t x = 0; x < image.width * 4; ++x)
+        {
+            const auto diff = static_cast<double>(a[x]) - static_cast<double>(b[x]);
+            squared_error += diff * diff;
+        }
+    }
+
+    const auto mse = squared_error / static_cast<double>(image.width * image.height * 4);
+    if (mse == 0)
+        return k_max_psnr;
+    return std::min(10.0 * std::log10(255.0 * 255.0 / mse), k_max_psnr);
+}
+
+/// @brief Encodes a gradient, decodes it back with DirectXTex and checks the PSNR of every mip level
+void check_round_trip(DXGI_FORMAT format, size_t width, size_t height, size_t mips, double min_psnr)
+{
+    CAPTURE(width);
+    CAPTURE(height);
+
+    auto executor = Executor(2, 1);
+
+    const auto reference = make_gradient_texture(width, height, mips);
+    auto input           = make_gradient_texture(width, height, mips);
+
+    auto encoded = encode_on_cpu(std::move(input), format, CompressionTier::Balanced, executor);
+    REQUIRE(encoded.has_value());
+
+    const auto &output = encoded->get();
+    CHECK(output.GetMetadata().format == format);
+    CHECK(output.GetMetadata().width == width);
+    CHECK(output.GetMetadata().height == height);
+    REQUIRE(output.GetImageCount() == reference.get().GetImageCount());
+
+    for (size_t mip = 0; mip < output.GetImageCount(); ++mip)
+    {
+        CAPTURE(mip);
+
+        auto decoded = DirectX::ScratchImage{};
+        REQUIRE(SUCCEEDED(DirectX::Decompress(output.GetImages()[mip], DXGI_FORMAT_R8G8B8A8_UNORM, decoded)));
+        CHECK(psnr(reference.get().GetImages()[mip], *decoded.GetImage(0, 0, 0)) >= min_psnr);
+    }
+}
+
+TEST_CASE("CPU encoder round trip to BC1")
+{
+    constexpr double k_min_psnr = 30.0;
+
+    SUBCASE("Whole blocks") { check_round_trip(DXGI_FORMAT_BC1_UNORM, 32, 16, 1, k_min_psnr); }
+    SUBCASE("Smaller than a block") { check_round_trip(DXGI_FORMAT_BC1_UNORM, 3, 2, 1, k_min_psnr); }
+    SUBCASE("Single pixel") { check_round_trip(DXGI_FORMAT_BC1_UNORM, 1, 1, 1, k_min_psnr); }
+    SUBCASE("Partial blocks and mipmaps") { check_round_trip(DXGI_FORMAT_BC1_UNORM, 13, 7, 4, k_min_psnr); }
+}
+
+TEST_CASE("CPU encoder round trip to BC7")
+{
+    constexpr double k_min_psnr = 40.0;
+
+    SUBCASE("Whole blocks") { check_round_trip(DXGI_FORMAT_BC7_UNORM, 32, 16, 1, k_min_psnr); }
+    SUBCASE("Smaller than a block") { check_round_trip(DXGI_FORMAT_BC7_UNORM, 3, 2, 1, k_min_psnr); }
+    SUBCASE("Single pixel") { check_round_trip(DXGI_FORMAT_BC7_UNORM, 1, 1, 1, k_min_psnr); }
+    SUBCASE("Partial blocks and mipmaps") { check_round_trip(DXGI_FORMAT_BC7_UNORM, 13, 7, 4, k_min_psnr); }
+}
+
+TEST_CASE("CPU encoder input")
+{
+    auto executor = Executor(1, 1);
+
+    const auto encode = [&](DXGI_FORMAT format) {
+        return encode_on_cpu(make_gradient_texture(8, 8, 1), format, CompressionTier::Fast, executor);
+    };
+
+    // The input must already use the uncompressed format of the target
+    CHECK_FALSE(encode(DXGI_FORMAT_BC1_UNORM_SRGB).has_value());
+    // Other formats go through the compression device
+    CHECK_FALSE(encode(DXGI_FORMAT_BC3_UNORM).has_value());
+    CHECK(encode(DXGI_FORMAT_BC1_UNORM).has_value());
+}
@@ -0,0 +1,56 @@
+/* Copyright (C) 2026 G'k
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace cao::test {
+/// @brief Empty directory, removed with its content when it goes out of scope
+class TempDirectory
+{
+public:
+    TempDirectory()
+        : path_(std::filesystem::temp_directory_path() / unique_name())
+    {
+        std::filesystem::create_directories(path_);
+    }
+
+    TempDirectory(const TempDirectory &)                     = delete;
+    auto operator=(const TempDirectory &) -> TempDirectory & = delete;
+
+    TempDirectory(TempDirectory &&)                     = delete;
+    auto operator=(TempDirectory &&) -> TempDirectory & = delete;
+
+    ~TempDirectory()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    [[nodiscard]] auto path() const noexcept -> const std::filesystem::path & { return path_; }
+
+private:
+    [[nodiscard]] static auto unique_name() -> std::string
+    {
+        static std::atomic_size_t counter = 0;
+        return "CAO_test_" + std::to_string(std::random_device{}()) + "_" + std::to_string(counter++);
+    }
+
+    std::filesystem::path path_;
+};
+
+/// @brief Writes `content` to `file_path`, creating its parent directories
+inline void write_file(const std::filesystem::path &file_path, std::string_view content = {})
+{
+    std::filesystem::create_directories(file_path.parent_path());
+    std::ofstream stream(file_path, std::ios::binary);
+    stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+} // namespace cao::test